@@ -18,6 +18,7 @@
 #include <string.h>
 #include <unistd.h>
 #include "adc.h"
+#include "sysfs.h"
 
 //------------------------------------------------------------------------------
 // default adc range (mV). ADC res 1.7578125mV (1800mV / 1024 bits)
@@ -63,14 +64,10 @@ static int adc_read (const char *path)
 {
     char rdata[16];
     int mV = 0;
-    FILE *fp;
 
-    memset (rdata, 0, sizeof (rdata));
     // adc raw value get
-    if ((fp = fopen(path, "r")) != NULL) {
-        fgets (rdata, sizeof(rdata), fp);
-        fclose(fp);
-    }
+    if (!sysfs_read_str (path, rdata, sizeof(rdata)))
+        return 0;
     mV = (atoi(rdata) * 1800) / 4096;
     return mV;
 }
@@ -80,9 +77,6 @@ int adc_check (int id)
 {
     int value = 0;
 
-    if (access (DeviceADC[id].path, R_OK) != 0)
-        return 0;
-
     value = adc_read (DeviceADC[id].path);
     if ((value < DeviceADC[id].max) && (value > DeviceADC[id].min))
         return value;
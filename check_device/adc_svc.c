@@ -0,0 +1,162 @@
+//------------------------------------------------------------------------------
+/**
+ * @file adc_svc.c
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG.
+ * @version 0.2
+ * @date 2023-10-12
+ *
+ * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+//------------------------------------------------------------------------------
+#include "../lib_i2cadc/lib_i2cadc.h"
+#include "adc_svc.h"
+
+//------------------------------------------------------------------------------
+//
+// ADC board service.
+// The ADC board fd (one i2c bus) is shared by the main loop, the header and
+// audio checks and the model detect. Every bus access is serialized here and
+// a whole connector is read in one pass. The timestamped snapshot is served
+// to every reader within its freshness window, a pin ("P13.2") is taken from
+// the snapshot of its connector.
+//
+//------------------------------------------------------------------------------
+#define ADC_PIN_MAX     40
+
+struct adc_snap {
+    const char  *name;
+    int         cnt;
+    // snapshot done time (monotonic ms), 0 = none
+    long long   ts;
+    // value[1] = pin 1
+    int         value[ADC_PIN_MAX +1];
+};
+
+static struct adc_snap AdcSnap[] = {
+    { "CON1", 0, 0, { 0 } },
+    { "P13",  0, 0, { 0 } },
+    { "P3",   0, 0, { 0 } },
+};
+
+#define ADC_SNAP_COUNT  (int)(sizeof(AdcSnap) / sizeof(AdcSnap[0]))
+
+static pthread_mutex_t AdcBus = PTHREAD_MUTEX_INITIALIZER;
+static int AdcFd = 0, AdcFresh = 0;
+
+// bus reads, snapshot hits
+static unsigned int AdcReads = 0, AdcHits = 0;
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+static long long adc_svc_now (void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+//------------------------------------------------------------------------------
+// "CON1" -> snapshot, pin = 0 / "P13.2" -> snapshot, pin = 2
+//------------------------------------------------------------------------------
+static struct adc_snap *adc_svc_snap (const char *name, int *pin)
+{
+    const char *dot = strchr (name, '.');
+    int i, len = dot ? (int)(dot - name) : (int)strlen (name);
+
+    *pin = dot ? atoi (dot + 1) : 0;
+    for (i = 0; i < ADC_SNAP_COUNT; i++) {
+        if (((int)strlen (AdcSnap[i].name) == len) && !strncmp (AdcSnap[i].name, name, len))
+            return &AdcSnap[i];
+    }
+    return NULL;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+void adc_svc_init (int fd, int fresh_ms)
+{
+    int i;
+
+    pthread_mutex_lock (&AdcBus);
+    AdcFd = fd;     AdcFresh = fresh_ms;
+    for (i = 0; i < ADC_SNAP_COUNT; i++)
+        AdcSnap[i].ts = 0;
+    pthread_mutex_unlock (&AdcBus);
+}
+
+//------------------------------------------------------------------------------
+// connector (value[0..cnt-1] = pin 1..cnt) or pin (value[0], cnt = 1).
+// return : snapshot age (ms), -1 on error.
+//------------------------------------------------------------------------------
+int adc_svc_read (const char *name, int max_age_ms, int *value, int *cnt)
+{
+    struct adc_snap *ps;
+    long long now;
+    int pin, age = -1;
+
+    if (max_age_ms < 0)
+        max_age_ms = AdcFresh;
+
+    pthread_mutex_lock (&AdcBus);
+    if (AdcFd <= 0)
+        goto out;
+
+    // not a snapshot connector : direct read, still serialized.
+    if ((ps = adc_svc_snap (name, &pin)) == NULL) {
+        AdcReads++;
+        adc_board_read (AdcFd, name, value, cnt);
+        age = 0;
+        goto out;
+    }
+
+    now = adc_svc_now ();
+    if (ps->ts && (now - ps->ts) <= max_age_ms) {
+        AdcHits++;
+    } else {
+        AdcReads++;
+        memset (ps->value, 0, sizeof(ps->value));
+        ps->cnt = 0;
+        adc_board_read (AdcFd, ps->name, &ps->value[1], &ps->cnt);
+        if (ps->cnt > ADC_PIN_MAX)
+            ps->cnt = ADC_PIN_MAX;
+        now = ps->ts = adc_svc_now ();
+    }
+
+    if (pin) {
+        if (pin > ps->cnt)
+            goto out;
+        *value = ps->value[pin];
+        *cnt   = 1;
+    } else {
+        memcpy (value, &ps->value[1], sizeof(int) * ps->cnt);
+        *cnt = ps->cnt;
+    }
+    age = (int)(now - ps->ts);
+out:
+    pthread_mutex_unlock (&AdcBus);
+    return age;
+}
+
+//------------------------------------------------------------------------------
+void adc_svc_stats (unsigned int *reads, unsigned int *hits)
+{
+    pthread_mutex_lock (&AdcBus);
+    *reads = AdcReads;  *hits = AdcHits;
+    pthread_mutex_unlock (&AdcBus);
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
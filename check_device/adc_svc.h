@@ -0,0 +1,35 @@
+//------------------------------------------------------------------------------
+/**
+ * @file adc_svc.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG.
+ * @version 0.2
+ * @date 2023-10-12
+ *
+ * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __ADC_SVC_H__
+#define __ADC_SVC_H__
+
+//------------------------------------------------------------------------------
+// max_age_ms : snapshot freshness, ADC_SVC_FRESH = default window (adc_svc_init)
+//------------------------------------------------------------------------------
+#define ADC_SVC_FRESH   -1
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+extern void adc_svc_init    (int fd, int fresh_ms);
+extern int  adc_svc_read    (const char *name, int max_age_ms, int *value, int *cnt);
+extern void adc_svc_stats   (unsigned int *reads, unsigned int *hits);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __ADC_SVC_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -13,6 +13,7 @@
  */
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <ctype.h>
 #include <stdarg.h>
@@ -29,6 +30,9 @@
 #include <arpa/inet.h>
 #include <linux/fb.h>
 #include <linux/sockios.h>
+#include <linux/ethtool.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
 #include <net/if.h>
 #include <netinet/in.h>
 #include <netinet/ip.h>
@@ -39,29 +43,83 @@
 #include <sys/mman.h>
 #include <sys/wait.h>
 #include <sys/ioctl.h>
+#include <sched.h>
+#include <poll.h>
+#include <ifaddrs.h>
 
 //------------------------------------------------------------------------------
 #include "ethernet.h"
+#include "sysfs.h"
 
 #define STR_PATH_LENGTH 128
+
 //------------------------------------------------------------------------------
-static int ethernet_link_speed (void)
+//
+// Configuration
+//
+//------------------------------------------------------------------------------
+// RK3588 : cpu0 ~ cpu3 (A55, LITTLE), cpu4 ~ cpu7 (A76, big)
+#define ETH_BIG_CPU_MASK    "f0"
+#define ETH_BIG_CPU_START   4
+#define ETH_BIG_CPU_END     8
+
+#define ETH_IRQ_NAME        "eth0"
+#define ETH_RPS_PATH        "/sys/class/net/eth0/queues/rx-0/rps_cpus"
+
+#define ETH_IFACE           "eth0"
+
+// iperf3 udp client (Mbits fixed format, verbose for cpu utilization)
+// same mode as the server side test (NLP_SERVER_MSG_TYPE_UDP), the target
+// bandwidth is split over the streams.
+#define IPERF3_CMD          "iperf3 -u -f m -V -t 2"
+#define IPERF3_BANDWIDTH    1000
+
+struct ethernet_affinity {
+    // eth0 irq number (0 = not found)
+    int irq;
+    // backup data (irq smp_affinity, rps_cpus)
+    char irq_mask[STR_PATH_LENGTH];
+    char rps_mask[STR_PATH_LENGTH];
+    // backup thread cpu affinity
+    cpu_set_t cpus;
+    int saved;
+};
+
+static struct ethernet_affinity EthAffinity;
+
+// link up(or wait start) to ip address assign time (ms), -1 = unknown
+static int EthIpLatency = -1;
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+// /proc/interrupts : " 89:  0  0 ... GICv3 130 Level  eth0"
+//------------------------------------------------------------------------------
+static int ethernet_irq_find (void)
 {
     FILE *fp;
-    char cmd_line[STR_PATH_LENGTH];
-
-    if (access ("/sys/class/net/eth0/speed", F_OK) != 0)
-        return 0;
+    char rdata[STR_PATH_LENGTH *4];
+    int irq = 0;
 
-    memset (cmd_line, 0x00, sizeof(cmd_line));
-    if ((fp = fopen ("/sys/class/net/eth0/speed", "r")) != NULL) {
-        memset (cmd_line, 0x00, sizeof(cmd_line));
-        if (NULL != fgets (cmd_line, sizeof(cmd_line), fp)) {
-            fclose (fp);
-            return atoi (cmd_line);
+    if ((fp = fopen ("/proc/interrupts", "r")) != NULL) {
+        while (fgets (rdata, sizeof(rdata), fp) != NULL) {
+            if (strstr (rdata, ETH_IRQ_NAME) != NULL) {
+                irq = atoi (rdata);
+                break;
+            }
         }
         fclose (fp);
     }
+    return irq;
+}
+
+//------------------------------------------------------------------------------
+static int ethernet_link_speed (void)
+{
+    char cmd_line[STR_PATH_LENGTH];
+
+    // link down : read error (EINVAL)
+    if (sysfs_read_str ("/sys/class/net/eth0/speed", cmd_line, sizeof(cmd_line)))
+        return atoi (cmd_line);
     return 0;
 }
 
@@ -92,5 +150,306 @@ int ethernet_link_setup (int speed)
     return 0;
 }
 
+//------------------------------------------------------------------------------
+// eth0 irq, rps queue and the calling thread are moved to the big cores.
+// The previous setting is saved and restored by ethernet_affinity_restore().
+//------------------------------------------------------------------------------
+int ethernet_affinity_set (void)
+{
+    struct ethernet_affinity *pa = &EthAffinity;
+    char path[STR_PATH_LENGTH];
+    cpu_set_t cpus;
+    int i;
+
+    if (pa->saved)
+        return 1;
+
+    memset (pa, 0, sizeof(struct ethernet_affinity));
+
+    if ((pa->irq = ethernet_irq_find ()) != 0) {
+        memset  (path, 0, sizeof(path));
+        sprintf (path, "/proc/irq/%d/smp_affinity", pa->irq);
+        if (sysfs_read_str (path, pa->irq_mask, sizeof(pa->irq_mask)))
+            sysfs_write (path, ETH_BIG_CPU_MASK);
+    }
+    if (sysfs_read_str (ETH_RPS_PATH, pa->rps_mask, sizeof(pa->rps_mask)))
+        sysfs_write (ETH_RPS_PATH, ETH_BIG_CPU_MASK);
+
+    // child process(popen) inherits the cpu affinity of the calling thread.
+    sched_getaffinity (0, sizeof(cpu_set_t), &pa->cpus);
+    CPU_ZERO (&cpus);
+    for (i = ETH_BIG_CPU_START; i < ETH_BIG_CPU_END; i++)
+        CPU_SET (i, &cpus);
+    if (sched_setaffinity (0, sizeof(cpu_set_t), &cpus))
+        printf ("%s : thread affinity set error(%d)\n", __func__, errno);
+
+    pa->saved = 1;
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+int ethernet_affinity_restore (void)
+{
+    struct ethernet_affinity *pa = &EthAffinity;
+    char path[STR_PATH_LENGTH];
+
+    if (!pa->saved)
+        return 0;
+
+    if (pa->irq && strlen (pa->irq_mask)) {
+        memset  (path, 0, sizeof(path));
+        sprintf (path, "/proc/irq/%d/smp_affinity", pa->irq);
+        sysfs_write (path, pa->irq_mask);
+    }
+    if (strlen (pa->rps_mask))
+        sysfs_write (ETH_RPS_PATH, pa->rps_mask);
+
+    sched_setaffinity (0, sizeof(cpu_set_t), &pa->cpus);
+    pa->saved = 0;
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+// return : throughput(Mbits/sec), cpu_usage : local cpu utilization x 100 (%)
+//------------------------------------------------------------------------------
+int ethernet_iperf_check (const char *ip, int streams, int *cpu_usage)
+{
+    FILE *fp;
+    char cmd[STR_PATH_LENGTH], rdata[STR_PATH_LENGTH *2], *ptr;
+    int mbits = 0;
+
+    if (cpu_usage)  *cpu_usage = 0;
+
+    memset  (cmd, 0, sizeof(cmd));
+    if (streams < 1)    streams = 1;
+    sprintf (cmd, "%s -b %dM -P %d -c %s 2>&1", IPERF3_CMD,
+                IPERF3_BANDWIDTH / streams, streams, ip);
+
+    if ((fp = popen (cmd, "r")) != NULL) {
+        while (fgets (rdata, sizeof(rdata), fp) != NULL) {
+            // "[SUM]   0.00-2.00   sec   224 MBytes   941 Mbits/sec   receiver"
+            if ((strstr (rdata, "receiver") != NULL) &&
+                ((streams < 2) || (strstr (rdata, "[SUM]") != NULL))) {
+                if ((ptr = strstr (rdata, " Mbits/sec")) != NULL) {
+                    while ((ptr > rdata) && (*(ptr-1) != ' '))  ptr--;
+                    mbits = atoi (ptr);
+                }
+            }
+            // "CPU Utilization: local/sender 12.3% (0.4%u/11.9%s), remote/receiver ..."
+            if (((ptr = strstr (rdata, "CPU Utilization: local/")) != NULL) && cpu_usage) {
+                float usage;
+
+                if (sscanf (ptr, "CPU Utilization: local/sender %f%%", &usage) == 1)
+                    *cpu_usage = (int)(usage * 100);
+            }
+        }
+        pclose (fp);
+    }
+    return mbits;
+}
+
+//------------------------------------------------------------------------------
+static int ethtool_ioctl (int fd, void *data)
+{
+    struct ifreq ifr;
+
+    memset  (&ifr, 0, sizeof(ifr));
+    strncpy (ifr.ifr_name, ETH_IFACE, IFNAMSIZ -1);
+    ifr.ifr_data = data;
+
+    return ioctl (fd, SIOCETHTOOL, &ifr);
+}
+
+//------------------------------------------------------------------------------
+// MAC/PHY loopback self-test (ethtool -t eth0 offline). No link partner needed.
+// return : 1 = pass, 0 = fail, -1 = not supported by the driver
+//------------------------------------------------------------------------------
+int ethernet_self_test (int speed)
+{
+    FILE *fp;
+    char cmd_line[STR_PATH_LENGTH];
+    struct {
+        struct ethtool_sset_info hdr;
+        __u32 data[1];
+    }   sset;
+    struct ethtool_test *test;
+    int fd, cnt, ret = -1;
+
+    // fixed speed without autoneg, the loopback path runs at the forced speed.
+    memset  (cmd_line, 0x00, sizeof(cmd_line));
+    sprintf (cmd_line, "ethtool -s %s speed %d duplex full autoneg off", ETH_IFACE, speed);
+    if ((fp = popen (cmd_line, "w")) != NULL)
+        pclose (fp);
+
+    if ((fd = socket (AF_INET, SOCK_DGRAM, 0)) < 0)
+        return -1;
+
+    memset (&sset, 0, sizeof(sset));
+    sset.hdr.cmd       = ETHTOOL_GSSET_INFO;
+    sset.hdr.sset_mask = 1ULL << ETH_SS_TEST;
+
+    if (ethtool_ioctl (fd, &sset) || !sset.hdr.sset_mask || !(cnt = sset.hdr.data[0])) {
+        printf ("%s : %s self-test not supported.\n", __func__, ETH_IFACE);
+        goto out;
+    }
+
+    if ((test = calloc (1, sizeof(struct ethtool_test) + cnt * sizeof(__u64))) == NULL)
+        goto out;
+
+    test->cmd   = ETHTOOL_TEST;
+    test->flags = ETH_TEST_FL_OFFLINE;
+    test->len   = cnt;
+
+    if (!ethtool_ioctl (fd, test))
+        ret = (test->flags & ETH_TEST_FL_FAILED) ? 0 : 1;
+
+    printf ("%s : %s %dM self-test(%d items) %s\n", __func__,
+            ETH_IFACE, speed, cnt, ret == 1 ? "PASS" : "FAIL");
+    free (test);
+out:
+    close (fd);
+    return ret;
+}
+
+//------------------------------------------------------------------------------
+int ethernet_self_test_end (void)
+{
+    FILE *fp;
+    char cmd_line[STR_PATH_LENGTH];
+
+    memset  (cmd_line, 0x00, sizeof(cmd_line));
+    sprintf (cmd_line, "ethtool -s %s speed %d duplex full autoneg on", ETH_IFACE, LINK_SPEED_1G);
+    if ((fp = popen (cmd_line, "w")) != NULL)
+        pclose (fp);
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+static unsigned long ethernet_ms (void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+//------------------------------------------------------------------------------
+static int ethernet_ip_get (char *ip)
+{
+    struct ifaddrs *ifa_list, *ifa;
+    int found = 0;
+
+    if (getifaddrs (&ifa_list))
+        return 0;
+
+    for (ifa = ifa_list; ifa != NULL; ifa = ifa->ifa_next) {
+        if ((ifa->ifa_addr == NULL) || (ifa->ifa_addr->sa_family != AF_INET))
+            continue;
+        if (strcmp (ifa->ifa_name, ETH_IFACE))
+            continue;
+        inet_ntop (AF_INET, &((struct sockaddr_in *)ifa->ifa_addr)->sin_addr,
+                    ip, INET_ADDRSTRLEN);
+        found = 1;
+        break;
+    }
+    freeifaddrs (ifa_list);
+    return found;
+}
+
+//------------------------------------------------------------------------------
+// netlink message parse. return 1 if the eth0 ipv4 address is assigned.
+//------------------------------------------------------------------------------
+static int ethernet_nl_parse (char *buf, int len, int ifindex, char *ip,
+                                int *running, unsigned long *link_up)
+{
+    struct nlmsghdr *nh;
+    struct ifinfomsg *ifi;
+    struct ifaddrmsg *ifa;
+    struct rtattr *rta;
+    int rlen;
+
+    for (nh = (struct nlmsghdr *)buf; NLMSG_OK (nh, (unsigned int)len); nh = NLMSG_NEXT (nh, len)) {
+        switch (nh->nlmsg_type) {
+            case RTM_NEWLINK:
+                ifi = (struct ifinfomsg *)NLMSG_DATA (nh);
+                if (ifi->ifi_index != ifindex)
+                    break;
+                // carrier up : dhcp latency start point
+                if ((ifi->ifi_flags & IFF_RUNNING) && !*running)
+                    *link_up = ethernet_ms ();
+                *running = (ifi->ifi_flags & IFF_RUNNING) ? 1 : 0;
+                break;
+            case RTM_NEWADDR:
+                ifa = (struct ifaddrmsg *)NLMSG_DATA (nh);
+                if ((ifa->ifa_family != AF_INET) || ((int)ifa->ifa_index != ifindex))
+                    break;
+                rlen = IFA_PAYLOAD (nh);
+                for (rta = IFA_RTA (ifa); RTA_OK (rta, rlen); rta = RTA_NEXT (rta, rlen)) {
+                    if ((rta->rta_type == IFA_LOCAL) || (rta->rta_type == IFA_ADDRESS)) {
+                        inet_ntop (AF_INET, RTA_DATA (rta), ip, INET_ADDRSTRLEN);
+                        return 1;
+                    }
+                }
+                break;
+            default :
+                break;
+        }
+    }
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+// eth0 ip address (getifaddrs + RTM_NEWADDR event). return 0 on timeout.
+//------------------------------------------------------------------------------
+int ethernet_ip_wait (char *ip, int timeout_ms)
+{
+    struct sockaddr_nl sa;
+    struct pollfd pfd;
+    char buf[4096];
+    unsigned long start = ethernet_ms (), link_up = start;
+    int fd, len, remain, found = 0, running = -1;
+    int ifindex = if_nametoindex (ETH_IFACE);
+
+    if ((fd = socket (AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE)) < 0)
+        return ethernet_ip_get (ip);
+
+    memset (&sa, 0, sizeof(sa));
+    sa.nl_family = AF_NETLINK;
+    sa.nl_groups = RTMGRP_IPV4_IFADDR | RTMGRP_LINK;
+
+    // subscribe first, then check the current address. (no missed event)
+    if (bind (fd, (struct sockaddr *)&sa, sizeof(sa)) || ethernet_ip_get (ip)) {
+        close (fd);
+        return ethernet_ip_get (ip);
+    }
+
+    while (!found) {
+        if ((remain = timeout_ms - (int)(ethernet_ms () - start)) <= 0)
+            break;
+
+        pfd.fd = fd;    pfd.events = POLLIN;    pfd.revents = 0;
+        if (poll (&pfd, 1, remain) <= 0)
+            break;
+
+        if ((len = recv (fd, buf, sizeof(buf), 0)) <= 0)
+            continue;
+
+        found = ethernet_nl_parse (buf, len, ifindex, ip, &running, &link_up);
+    }
+    close (fd);
+
+    if (found) {
+        EthIpLatency = (int)(ethernet_ms () - link_up);
+        printf ("%s : %s ip = %s, dhcp latency = %d ms\n", __func__, ETH_IFACE, ip, EthIpLatency);
+    }
+    return found;
+}
+
+//------------------------------------------------------------------------------
+int ethernet_ip_latency (void)
+{
+    return EthIpLatency;
+}
+
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
@@ -26,6 +26,13 @@
 //------------------------------------------------------------------------------
 extern int ethernet_link_check (void);
 extern int ethernet_link_setup (int speed);
+extern int ethernet_affinity_set     (void);
+extern int ethernet_affinity_restore (void);
+extern int ethernet_iperf_check      (const char *ip, int streams, int *cpu_usage);
+extern int ethernet_self_test        (int speed);
+extern int ethernet_self_test_end    (void);
+extern int ethernet_ip_wait          (char *ip, int timeout_ms);
+extern int ethernet_ip_latency       (void);
 
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
@@ -0,0 +1,116 @@
+//------------------------------------------------------------------------------
+/**
+ * @file gpio_event.c
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG.
+ * @version 0.2
+ * @date 2023-10-12
+ *
+ * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+
+//------------------------------------------------------------------------------
+#include "gpio_event.h"
+
+//------------------------------------------------------------------------------
+//
+// GPIO line event (v2 uAPI).
+// both edge, kernel debounce, event timestamp : CLOCK_MONOTONIC (ns)
+// gpio number / 32 = bank (/dev/gpiochipN), gpio number % 32 = line offset.
+//
+//------------------------------------------------------------------------------
+#define GPIO_BANK_LINES 32
+#define GPIO_CHIP_PATH  "/dev/gpiochip%d"
+#define GPIO_CONSUMER   "jig-event"
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+unsigned long long gpio_event_now (void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+//------------------------------------------------------------------------------
+// return : line event fd (-1 : error), value : current line level
+//------------------------------------------------------------------------------
+int gpio_event_open (int gpio, int debounce_us, int *value)
+{
+    struct gpio_v2_line_request req;
+    struct gpio_v2_line_values values;
+    char path[32];
+    int fd;
+
+    sprintf (path, GPIO_CHIP_PATH, gpio / GPIO_BANK_LINES);
+    if ((fd = open (path, O_RDWR | O_CLOEXEC)) < 0)
+        return -1;
+
+    memset (&req, 0, sizeof(req));
+    req.offsets[0]   = gpio % GPIO_BANK_LINES;
+    req.num_lines    = 1;
+    req.config.flags = GPIO_V2_LINE_FLAG_INPUT |
+                       GPIO_V2_LINE_FLAG_EDGE_RISING | GPIO_V2_LINE_FLAG_EDGE_FALLING;
+    strncpy (req.consumer, GPIO_CONSUMER, sizeof(req.consumer) -1);
+
+    if (debounce_us) {
+        req.config.num_attrs = 1;
+        req.config.attrs[0].mask = 1;
+        req.config.attrs[0].attr.id = GPIO_V2_LINE_ATTR_ID_DEBOUNCE;
+        req.config.attrs[0].attr.debounce_period_us = debounce_us;
+    }
+
+    if (ioctl (fd, GPIO_V2_GET_LINE_IOCTL, &req) < 0) {
+        printf ("%s : gpio %d request error(%s)\n", __func__, gpio, strerror (errno));
+        close (fd);
+        return -1;
+    }
+    close (fd);
+
+    memset (&values, 0, sizeof(values));
+    values.mask = 1;
+    if (value && !ioctl (req.fd, GPIO_V2_LINE_GET_VALUES_IOCTL, &values))
+        *value = values.bits & 1;
+
+    return req.fd;
+}
+
+//------------------------------------------------------------------------------
+// timeout_ms : -1 wait forever
+// return : 1 edge event (value, ts_ns : kernel timestamp), 0 timeout, -1 error
+//------------------------------------------------------------------------------
+int gpio_event_wait (int fd, int timeout_ms, int *value, unsigned long long *ts_ns)
+{
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    struct gpio_v2_line_event ev;
+    int ret;
+
+    if ((ret = poll (&pfd, 1, timeout_ms)) <= 0)
+        return (ret < 0 && errno != EINTR) ? -1 : 0;
+
+    if (read (fd, &ev, sizeof(ev)) != sizeof(ev))
+        return -1;
+
+    if (value)  *value = (ev.id == GPIO_V2_LINE_EVENT_RISING_EDGE) ? 1 : 0;
+    if (ts_ns)  *ts_ns = ev.timestamp_ns;
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,30 @@
+//------------------------------------------------------------------------------
+/**
+ * @file gpio_event.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG.
+ * @version 0.2
+ * @date 2023-10-12
+ *
+ * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __GPIO_EVENT_H__
+#define __GPIO_EVENT_H__
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+extern int gpio_event_open  (int gpio, int debounce_us, int *value);
+extern int gpio_event_wait  (int fd, int timeout_ms, int *value, unsigned long long *ts_ns);
+extern unsigned long long gpio_event_now (void);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __GPIO_EVENT_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
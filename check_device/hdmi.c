@@ -24,6 +24,7 @@
 
 //------------------------------------------------------------------------------
 #include "hdmi.h"
+#include "sysfs.h"
 
 //------------------------------------------------------------------------------
 struct device_led {
@@ -64,15 +65,8 @@ struct device_led DeviceHDMI [eHDMI_END] = {
 //------------------------------------------------------------------------------
 static int hdmi_read (const char *path, char *rdata)
 {
-    FILE *fp;
-
-    // led value get
-    if ((fp = fopen(path, "r")) != NULL) {
-        fread (rdata, 1, HDMI_READ_BYTES, fp);
-        fclose(fp);
-        return 1;
-    }
-    return 0;
+    // edid / hpd value get
+    return (sysfs_read (path, rdata, HDMI_READ_BYTES) >= 0);
 }
 
 //------------------------------------------------------------------------------
@@ -109,7 +103,7 @@ int hdmi_check (int id)
     int value = 0;
     char rdata[HDMI_READ_BYTES];
 
-    if ((id >= eHDMI_END) || (access (DeviceHDMI[id].path, R_OK) != 0)) {
+    if (id >= eHDMI_END) {
         return 0;
     }
 
@@ -121,5 +115,38 @@ int hdmi_check (int id)
     return value;
 }
 
+//------------------------------------------------------------------------------
+// raw data string for the server (EDID : hex bytes, HPD : status string)
+//------------------------------------------------------------------------------
+int hdmi_data (int id, char *str, int bytes)
+{
+    unsigned char rdata[HDMI_READ_BYTES];
+    int i;
+
+    if (id >= eHDMI_END) {
+        return 0;
+    }
+
+    memset (rdata, 0, sizeof(rdata));
+    if (!hdmi_read (DeviceHDMI[id].path, (char *)rdata))
+        return 0;
+
+    if (bytes > HDMI_READ_BYTES)    bytes = HDMI_READ_BYTES;
+
+    switch (id) {
+        case eHDMI_EDID:
+            for (i = 0; i < bytes; i++)
+                sprintf (&str[i * 2], "%02X", rdata[i]);
+            break;
+        case eHDMI_HPD:
+            strncpy (str, (char *)rdata, bytes);
+            str[strcspn (str, "\r\n")] = 0;
+            break;
+        default :
+            return 0;
+    }
+    return 1;
+}
+
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
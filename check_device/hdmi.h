@@ -30,6 +30,7 @@ enum {
 // function prototype
 //------------------------------------------------------------------------------
 extern int hdmi_check     (int id);
+extern int hdmi_data      (int id, char *str, int bytes);
 
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
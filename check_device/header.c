@@ -31,6 +31,7 @@
 #include <getopt.h>
 #include <pthread.h>
 #include <sys/sysinfo.h>
+#include <linux/gpio.h>
 
 //------------------------------------------------------------------------------
 #include "../lib_gpio/lib_gpio.h"
@@ -86,185 +87,324 @@ const int HEADER40[] = {
      NC,  NC,   // | 39 : GND      || 40 : ADC.AIN5 |
 };
 
+#define H14_COUNT   (int)(sizeof(HEADER14)/sizeof(int))
+#define H40_COUNT   (int)(sizeof(HEADER40)/sizeof(int))
+
+//------------------------------------------------------------------------------
+// GPIO character device (v2 uAPI).
+// gpio number / 32 = bank (/dev/gpiochipN), gpio number % 32 = line offset.
+// All header lines of a bank are one line request, a pattern is one
+// GPIO_V2_LINE_SET_VALUES_IOCTL per bank. (sysfs lib_gpio if not available)
 //------------------------------------------------------------------------------
-#define PATTERN_COUNT   4
-
-const int H14_PATTERN[PATTERN_COUNT][sizeof(HEADER14)] = {
-    // Pattern 0 : ALL High
-    {
-        // Header J3 GPIOs
-        NC,     // Not used (pin 0)
-        NC, NC, // | 01 : DC_JACK  || 02 : 3.3V      |
-        NC, NC, // | 03 : DC_JACK  || 04 : HP_R      |
-        NC, NC, // | 05 : HP_DET   || 06 : GND       |
-        NC, NC, // | 07 : MIC_IN_P || 08 : HP_L      |
-        NC, NC, // | 09 : PWRBTN   || 10 : RESET_H   |
-        NC, NC, // | 11 : GPIO3_C4 || 12 : GPIO3_C5  |
-         1, NC, // | 13 : GPIO3_C6 || 14 : GND       |
-    },
-    // Pattern 1 : ALL Low
-    {
-        // Header J3 GPIOs
-        NC,     // Not used (pin 0)
-        NC, NC, // | 01 : DC_JACK  || 02 : 3.3V      |
-        NC, NC, // | 03 : DC_JACK  || 04 : HP_R      |
-        NC, NC, // | 05 : HP_DET   || 06 : GND       |
-        NC, NC, // | 07 : MIC_IN_P || 08 : HP_L      |
-        NC, NC, // | 09 : PWRBTN   || 10 : RESET_H   |
-        NC, NC, // | 11 : GPIO3_C4 || 12 : GPIO3_C5  |
-         0, NC, // | 13 : GPIO3_C6 || 14 : GND       |
-    },
-    // Pattern 2 : Cross 0
-    {
-        // Header J3 GPIOs
-        NC,     // Not used (pin 0)
-        NC, NC, // | 01 : DC_JACK  || 02 : 3.3V      |
-        NC, NC, // | 03 : DC_JACK  || 04 : HP_R      |
-        NC, NC, // | 05 : HP_DET   || 06 : GND       |
-        NC, NC, // | 07 : MIC_IN_P || 08 : HP_L      |
-        NC, NC, // | 09 : PWRBTN   || 10 : RESET_H   |
-        NC, NC, // | 11 : GPIO3_C4 || 12 : GPIO3_C5  |
-         1, NC, // | 13 : GPIO3_C6 || 14 : GND       |
-    },
-    // Pattern 3 : Cross 1
-    {
-        // Header J3 GPIOs
-        NC,     // Not used (pin 0)
-        NC, NC, // | 01 : DC_JACK  || 02 : 3.3V      |
-        NC, NC, // | 03 : DC_JACK  || 04 : HP_R      |
-        NC, NC, // | 05 : HP_DET   || 06 : GND       |
-        NC, NC, // | 07 : MIC_IN_P || 08 : HP_L      |
-        NC, NC, // | 09 : PWRBTN   || 10 : RESET_H   |
-        NC, NC, // | 11 : GPIO3_C4 || 12 : GPIO3_C5  |
-         0, NC, // | 13 : GPIO3_C6 || 14 : GND       |
-    },
+#define GPIO_BANK_LINES 32
+#define GPIO_BANK_MAX   5
+#define GPIO_CHIP_PATH  "/dev/gpiochip%d"
+#define GPIO_CONSUMER   "jig-header"
+
+struct header_bank {
+    // line request fd (-1 : not used)
+    int fd, cnt;
+    unsigned int offsets[GPIO_BANK_LINES];
 };
 
-const int H40_PATTERN[PATTERN_COUNT][sizeof(HEADER40)] = {
-    // Pattern 0 : ALL High
-    {
-        // Header J2 GPIOs
-        NC,       // Not used (pin 0)
-        NC, NC,   // | 01 : 3.3V     || 02 : 5.0V     |
-         1, NC,   // | 03 : GPIO4_A7 || 04 : 5.0V     |
-         1, NC,   // | 05 : GPIO4_A6 || 06 : GND      |
-         1,  1,   // | 07 : GPIO0_D0 || 08 : GPIO3_C0 |
-        NC,  1,   // | 09 : GND      || 10 : GPIO3_C1 |
-         1,  1,   // | 11 : GPIO3_D4 || 12 : GPIO3_B2 |
-         1, NC,   // | 13 : GPIO3_D5 || 14 : GND      |
-         1,  1,   // | 15 : GPIO4_B3 || 16 : GPIO1_B2 |
-        NC,  1,   // | 17 : 3.3V     || 18 : GPIO1_B3 |
-         1, NC,   // | 19 : GPIO3_D2 || 20 : GND      |
-         1,  1,   // | 21 : GPIO3_D1 || 22 : GPIO0_D4 |
-         1,  1,   // | 23 : GPIO3_D3 || 24 : GPIO0_D5 |
-        NC,  1,   // | 25 : GND      || 26 : GPIO1_B4 |
-         1,  1,   // | 27 : GPIO4_B0 || 28 : GPIO4_B1 |
-         1, NC,   // | 29 : GPIO1_B7 || 30 : GND      |
-         1,  1,   // | 31 : GPIO1_B6 || 32 : GPIO4_B4 |
-         1, NC,   // | 33 : GPIO3_D0 || 34 : GND      |
-         1,  1,   // | 35 : GPIO3_C7 || 36 : GPIO4_B5 |
-        NC, NC,   // | 37 : ADC.AIN4 || 38 : 1.8V     |
-        NC, NC,   // | 39 : GND      || 40 : ADC.AIN5 |
-    },
-    // Pattern 1 : ALL Low
-    {
-        // Header J2 GPIOs
-        NC,       // Not used (pin 0)
-        NC, NC,   // | 01 : 3.3V     || 02 : 5.0V     |
-         0, NC,   // | 03 : GPIO4_A7 || 04 : 5.0V     |
-         0, NC,   // | 05 : GPIO4_A6 || 06 : GND      |
-         0,  0,   // | 07 : GPIO0_D0 || 08 : GPIO3_C0 |
-        NC,  0,   // | 09 : GND      || 10 : GPIO3_C1 |
-         0,  0,   // | 11 : GPIO3_D4 || 12 : GPIO3_B2 |
-         0, NC,   // | 13 : GPIO3_D5 || 14 : GND      |
-         0,  0,   // | 15 : GPIO4_B3 || 16 : GPIO1_B2 |
-        NC,  0,   // | 17 : 3.3V     || 18 : GPIO1_B3 |
-         0, NC,   // | 19 : GPIO3_D2 || 20 : GND      |
-         0,  0,   // | 21 : GPIO3_D1 || 22 : GPIO0_D4 |
-         0,  0,   // | 23 : GPIO3_D3 || 24 : GPIO0_D5 |
-        NC,  0,   // | 25 : GND      || 26 : GPIO1_B4 |
-         0,  0,   // | 27 : GPIO4_B0 || 28 : GPIO4_B1 |
-         0, NC,   // | 29 : GPIO1_B7 || 30 : GND      |
-         0,  0,   // | 31 : GPIO1_B6 || 32 : GPIO4_B4 |
-         0, NC,   // | 33 : GPIO3_D0 || 34 : GND      |
-         0,  0,   // | 35 : GPIO3_C7 || 36 : GPIO4_B5 |
-        NC, NC,   // | 37 : ADC.AIN4 || 38 : 1.8V     |
-        NC, NC,   // | 39 : GND      || 40 : ADC.AIN5 |
-    },
-    // Pattern 2 : Cross 0
-    {
-        // Header J2 GPIOs
-        NC,       // Not used (pin 0)
-        NC, NC,   // | 01 : 3.3V     || 02 : 5.0V     |
-         0, NC,   // | 03 : GPIO4_A7 || 04 : 5.0V     |
-         1, NC,   // | 05 : GPIO4_A6 || 06 : GND      |
-         0,  1,   // | 07 : GPIO0_D0 || 08 : GPIO3_C0 |
-        NC,  0,   // | 09 : GND      || 10 : GPIO3_C1 |
-         0,  1,   // | 11 : GPIO3_D4 || 12 : GPIO3_B2 |
-         1, NC,   // | 13 : GPIO3_D5 || 14 : GND      |
-         0,  1,   // | 15 : GPIO4_B3 || 16 : GPIO1_B2 |
-        NC,  0,   // | 17 : 3.3V     || 18 : GPIO1_B3 |
-         1, NC,   // | 19 : GPIO3_D2 || 20 : GND      |
-         0,  1,   // | 21 : GPIO3_D1 || 22 : GPIO0_D4 |
-         1,  0,   // | 23 : GPIO3_D3 || 24 : GPIO0_D5 |
-        NC,  1,   // | 25 : GND      || 26 : GPIO1_B4 |
-         1,  0,   // | 27 : GPIO4_B0 || 28 : GPIO4_B1 |
-         0, NC,   // | 29 : GPIO1_B7 || 30 : GND      |
-         1,  0,   // | 31 : GPIO1_B6 || 32 : GPIO4_B4 |
-         0, NC,   // | 33 : GPIO3_D0 || 34 : GND      |
-         1,  0,   // | 35 : GPIO3_C7 || 36 : GPIO4_B5 |
-        NC, NC,   // | 37 : ADC.AIN4 || 38 : 1.8V     |
-        NC, NC,   // | 39 : GND      || 40 : ADC.AIN5 |
-    },
-    // Pattern 3 : Cross 1
-    {
-        // Header J2 GPIOs
-        NC,       // Not used (pin 0)
-        NC, NC,   // | 01 : 3.3V     || 02 : 5.0V     |
-         1, NC,   // | 03 : GPIO4_A7 || 04 : 5.0V     |
-         0, NC,   // | 05 : GPIO4_A6 || 06 : GND      |
-         1,  0,   // | 07 : GPIO0_D0 || 08 : GPIO3_C0 |
-        NC,  1,   // | 09 : GND      || 10 : GPIO3_C1 |
-         1,  0,   // | 11 : GPIO3_D4 || 12 : GPIO3_B2 |
-         0, NC,   // | 13 : GPIO3_D5 || 14 : GND      |
-         1,  0,   // | 15 : GPIO4_B3 || 16 : GPIO1_B2 |
-        NC,  1,   // | 17 : 3.3V     || 18 : GPIO1_B3 |
-         0, NC,   // | 19 : GPIO3_D2 || 20 : GND      |
-         1,  0,   // | 21 : GPIO3_D1 || 22 : GPIO0_D4 |
-         0,  1,   // | 23 : GPIO3_D3 || 24 : GPIO0_D5 |
-        NC,  0,   // | 25 : GND      || 26 : GPIO1_B4 |
-         0,  1,   // | 27 : GPIO4_B0 || 28 : GPIO4_B1 |
-         1, NC,   // | 29 : GPIO1_B7 || 30 : GND      |
-         0,  1,   // | 31 : GPIO1_B6 || 32 : GPIO4_B4 |
-         1, NC,   // | 33 : GPIO3_D0 || 34 : GND      |
-         0,  1,   // | 35 : GPIO3_C7 || 36 : GPIO4_B5 |
-        NC, NC,   // | 37 : ADC.AIN4 || 38 : 1.8V     |
-        NC, NC,   // | 39 : GND      || 40 : ADC.AIN5 |
-    },
+struct header_cdev {
+    int init;
+    struct header_bank bank[GPIO_BANK_MAX];
+    // header pin -> request line index of the bank
+    int h14_line[H14_COUNT], h40_line[H40_COUNT];
 };
 
+static struct header_cdev HeaderCdev;
+
 //------------------------------------------------------------------------------
+//
+// Header patterns (constant weight code).
+// Every header line gets a unique 13 bits code with 8 bits set (HeaderCode),
+// pattern n drives bit n of the line code.
+//  - every line is driven high(8 patterns) and low(5 patterns) : stuck pin.
+//  - any two codes differ, a short is found whichever line drives the net.
+//  - any two codes share a high bit (a & b != 0) and a low bit (a | b != all),
+//    a wired-AND / wired-OR short is never read as a stuck pin.
+//  - the AND of every code pair is unique, the lines of a wired-AND (or mid
+//    level) short read a level no other pair can make. Failed lines with the
+//    same readings are reported as one short group.
+//    (wired-OR : the OR of two pairs may match, the group can merge 2 shorts)
+//
 //------------------------------------------------------------------------------
-static int pattern_write (int pattern)
+#define PATTERN_COUNT   HEADER_PATTERN_COUNT
+#define CODE_MASK       ((1u << PATTERN_COUNT) -1)
+
+// 13 bits, weight 8 : pairwise AND unique and != 0, pairwise OR != CODE_MASK
+static const unsigned int HeaderCode[] = {
+    0x01fe, 0x03b7, 0x03dd, 0x06db, 0x06ed, 0x0a7d, 0x0c7b, 0x0dce, 0x0f35,
+    0x0fb8, 0x119f, 0x11f3, 0x12af, 0x1376, 0x153e, 0x15b5, 0x16e3, 0x174d,
+    0x175a, 0x1765, 0x18dd, 0x1ae6, 0x1b2b, 0x1bd8, 0x1de1, 0x1eb4,
+};
+
+#define CODE_COUNT      (int)(sizeof(HeaderCode)/sizeof(HeaderCode[0]))
+
+// adc level (mV) of the header pin
+#define PIN_HIGH_MV     3000
+#define PIN_LOW_MV      300
+
+struct header_line {
+    // 40 : HEADER40, 14 : HEADER14, header pin number
+    int header, pin;
+    unsigned int code;
+};
+
+//------------------------------------------------------------------------------
+// Patterns compiled into bitmasks (bit n = header pin n) by header_init.
+// used : controlled pins, level : pin level of the pattern,
+// high/low : adc readings of the pattern.
+//------------------------------------------------------------------------------
+struct header_mask {
+    unsigned long long h14_used, h14[PATTERN_COUNT], h14_high[PATTERN_COUNT], h14_low[PATTERN_COUNT];
+    unsigned long long h40_used, h40[PATTERN_COUNT], h40_high[PATTERN_COUNT], h40_low[PATTERN_COUNT];
+    // read pattern bits
+    unsigned int read;
+
+    int line_cnt;
+    struct header_line line[H40_COUNT + H14_COUNT];
+};
+
+static struct header_mask HeaderMask;
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+static int cdev_line_add (struct header_cdev *pc, int gpio)
 {
-    if (pattern < PATTERN_COUNT) {
-        int i;
-        for (i = 0; i < (int)(sizeof(HEADER14)/sizeof(int)); i++) {
-            if (HEADER14[i]) {
-                gpio_set_value (HEADER14[i], H14_PATTERN[pattern][i]);
-            }
-        }
-        for (i = 0; i < (int)(sizeof(HEADER40)/sizeof(int)); i++) {
-            if (HEADER40[i]) {
-                gpio_set_value (HEADER40[i], H40_PATTERN[pattern][i]);
-            }
+    struct header_bank *pb = &pc->bank[gpio / GPIO_BANK_LINES];
+
+    pb->offsets[pb->cnt] = gpio % GPIO_BANK_LINES;
+    return pb->cnt++;
+}
+
+//------------------------------------------------------------------------------
+static void cdev_close (struct header_cdev *pc)
+{
+    int i;
+
+    for (i = 0; i < GPIO_BANK_MAX; i++) {
+        if (pc->bank[i].fd >= 0)
+            close (pc->bank[i].fd);
+        pc->bank[i].fd = -1;
+    }
+    pc->init = 0;
+}
+
+//------------------------------------------------------------------------------
+// request all header lines (output, low). return 0 if not available.
+//------------------------------------------------------------------------------
+static int cdev_init (struct header_cdev *pc)
+{
+    struct gpio_v2_line_request req;
+    char path[32];
+    int i, fd;
+
+    memset (pc, 0, sizeof(struct header_cdev));
+    for (i = 0; i < GPIO_BANK_MAX; i++)
+        pc->bank[i].fd = -1;
+
+    for (i = 0; i < H14_COUNT; i++)
+        if (HEADER14[i])    pc->h14_line[i] = cdev_line_add (pc, HEADER14[i]);
+    for (i = 0; i < H40_COUNT; i++)
+        if (HEADER40[i])    pc->h40_line[i] = cdev_line_add (pc, HEADER40[i]);
+
+    for (i = 0; i < GPIO_BANK_MAX; i++) {
+        if (!pc->bank[i].cnt)
+            continue;
+
+        sprintf (path, GPIO_CHIP_PATH, i);
+        if ((fd = open (path, O_RDWR | O_CLOEXEC)) < 0)
+            goto err_out;
+
+        memset (&req, 0, sizeof(req));
+        memcpy (req.offsets, pc->bank[i].offsets, pc->bank[i].cnt * sizeof(unsigned int));
+        strncpy (req.consumer, GPIO_CONSUMER, sizeof(req.consumer) -1);
+        req.num_lines    = pc->bank[i].cnt;
+        req.config.flags = GPIO_V2_LINE_FLAG_OUTPUT;
+
+        if (ioctl (fd, GPIO_V2_GET_LINE_IOCTL, &req) < 0) {
+            close (fd);
+            goto err_out;
         }
-        return 1;
+        close (fd);
+        pc->bank[i].fd = req.fd;
     }
+    pc->init = 1;
+    return 1;
+
+err_out:
+    printf ("%s : gpio cdev request error(%s), use sysfs.\n", __func__, strerror (errno));
+    cdev_close (pc);
     return 0;
 }
 
 //------------------------------------------------------------------------------
+static void pattern_line_add (struct header_mask *pm, int header, int pin)
+{
+    struct header_line *pl;
+    int id;
+
+    if (pm->line_cnt >= CODE_COUNT) {
+        printf ("%s : no code for header %d pin %d (max %d lines)\n",
+                __func__, header, pin, CODE_COUNT);
+        return;
+    }
+    pl = &pm->line[pm->line_cnt];
+    pl->header = header;
+    pl->pin    = pin;
+    pl->code   = HeaderCode[pm->line_cnt++];
+
+    for (id = 0; id < PATTERN_COUNT; id++) {
+        if (!(pl->code & (1u << id)))
+            continue;
+        if (header == 40)   pm->h40[id] |= 1ULL << pin;
+        else                pm->h14[id] |= 1ULL << pin;
+    }
+}
+
+//------------------------------------------------------------------------------
+static void pattern_compile (struct header_mask *pm)
+{
+    int i;
+
+    memset (pm, 0, sizeof(struct header_mask));
+    for (i = 0; i < H40_COUNT; i++) {
+        if (HEADER40[i]) {
+            pm->h40_used |= 1ULL << i;
+            pattern_line_add (pm, 40, i);
+        }
+    }
+    for (i = 0; i < H14_COUNT; i++) {
+        if (HEADER14[i]) {
+            pm->h14_used |= 1ULL << i;
+            pattern_line_add (pm, 14, i);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+// one ioctl per bank, all lines of the bank change at once.
+//------------------------------------------------------------------------------
+static int cdev_pattern_write (struct header_cdev *pc, int pattern)
+{
+    struct header_mask *pm = &HeaderMask;
+    struct gpio_v2_line_values values[GPIO_BANK_MAX];
+    int i, b;
+
+    memset (values, 0, sizeof(values));
+    for (i = 0; i < H14_COUNT; i++) {
+        if (HEADER14[i]) {
+            b = HEADER14[i] / GPIO_BANK_LINES;
+            values[b].mask |= 1ULL << pc->h14_line[i];
+            values[b].bits |= ((pm->h14[pattern] >> i) & 1ULL) << pc->h14_line[i];
+        }
+    }
+    for (i = 0; i < H40_COUNT; i++) {
+        if (HEADER40[i]) {
+            b = HEADER40[i] / GPIO_BANK_LINES;
+            values[b].mask |= 1ULL << pc->h40_line[i];
+            values[b].bits |= ((pm->h40[pattern] >> i) & 1ULL) << pc->h40_line[i];
+        }
+    }
+    for (b = 0; b < GPIO_BANK_MAX; b++) {
+        if ((pc->bank[b].fd >= 0) &&
+            (ioctl (pc->bank[b].fd, GPIO_V2_LINE_SET_VALUES_IOCTL, &values[b]) < 0))
+            return 0;
+    }
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+static int pattern_write (int pattern)
+{
+    struct header_mask *pm = &HeaderMask;
+    int i;
+
+    if (pattern >= PATTERN_COUNT)
+        return 0;
+
+    if (HeaderCdev.init)
+        return cdev_pattern_write (&HeaderCdev, pattern);
+
+    for (i = 0; i < H14_COUNT; i++) {
+        if (HEADER14[i])
+            gpio_set_value (HEADER14[i], (pm->h14[pattern] >> i) & 1);
+    }
+    for (i = 0; i < H40_COUNT; i++) {
+        if (HEADER40[i])
+            gpio_set_value (HEADER40[i], (pm->h40[pattern] >> i) & 1);
+    }
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+// adc (mV) -> high/low pin bitmask. (between PIN_LOW_MV ~ PIN_HIGH_MV : none)
+//------------------------------------------------------------------------------
+static void pattern_level (const int *mv, int count,
+                           unsigned long long *high, unsigned long long *low)
+{
+    int i;
+
+    *high = *low = 0;
+    for (i = 0; i < count; i++) {
+        if (mv[i] >= PIN_HIGH_MV)   *high |= 1ULL << i;
+        if (mv[i] <= PIN_LOW_MV)    *low  |= 1ULL << i;
+    }
+}
+
+//------------------------------------------------------------------------------
+// readings of the line (bit n = pattern n)
+//------------------------------------------------------------------------------
+static void line_level (struct header_mask *pm, struct header_line *pl,
+                        unsigned int *high, unsigned int *low)
+{
+    int id;
+
+    *high = *low = 0;
+    for (id = 0; id < PATTERN_COUNT; id++) {
+        unsigned long long h = (pl->header == 40) ? pm->h40_high[id] : pm->h14_high[id];
+        unsigned long long l = (pl->header == 40) ? pm->h40_low [id] : pm->h14_low [id];
+
+        if ((h >> pl->pin) & 1)     *high |= 1u << id;
+        if ((l >> pl->pin) & 1)     *low  |= 1u << id;
+    }
+}
+
+//------------------------------------------------------------------------------
+static int line_fault (struct header_mask *pm, struct header_line *pl,
+                       unsigned int *high, unsigned int *low)
+{
+    unsigned int h, l;
+
+    line_level (pm, pl, &h, &l);
+    if (high)   *high = h;
+    if (low)    *low  = l;
+
+    if ((h == pl->code) && (l == (~pl->code & CODE_MASK)))
+        return eHEADER_END;
+    if (!h && (l == CODE_MASK))
+        return eHEADER_STUCK_LOW;
+    if ((h == CODE_MASK) && !l)
+        return eHEADER_STUCK_HIGH;
+    return eHEADER_FAULT;
+}
+
+//------------------------------------------------------------------------------
+static int line_str (char *str, int size, struct header_line *pl, const char *sep)
+{
+    int len;
+
+    if (size <= 1)
+        return 0;
+
+    // J2 pin : "3", J3 pin : "J3.13"
+    len = snprintf (str, size, "%s%s%d", sep, (pl->header == 40) ? "" : "J3.", pl->pin);
+    return (len < size) ? len : size -1;
+}
+
 //------------------------------------------------------------------------------
 int header_pattern_set (int id)
 {
@@ -273,46 +413,85 @@ int header_pattern_set (int id)
 }
 
 //------------------------------------------------------------------------------
-int header_pattern_check (int id, int *pattern40, int *pattern14)
+// pattern40[41], pattern14[15] : adc(mV) of the header pin number.
+// return : failing pin count of the pattern (0 = pass)
+//------------------------------------------------------------------------------
+int header_pattern_read (int id, int *pattern40, int *pattern14)
 {
-    int i;
-    if (id < PATTERN_COUNT) {
-        for (i = 0; i < (int)(sizeof(HEADER14)/sizeof(int)); i++) {
-            if (HEADER14[i]) {
-                if (H14_PATTERN[id][i]){
-                    if (pattern14[i] < 3000) {
-                        printf ("PT%d GPIO - %d : %d %dmV\n",
-                            id, HEADER14[i], H14_PATTERN[id][i], pattern14[i]);
-                        return 0;
-                    }
-                } else {
-                    if (pattern14[i] > 300) {
-                        printf ("PT%d GPIO - %d : %d %dmV\n",
-                            id, HEADER14[i], H14_PATTERN[id][i], pattern14[i]);
-                        return 0;
-                    }
-                }
-            }
+    struct header_mask *pm = &HeaderMask;
+    unsigned long long fail40, fail14;
+
+    if (id >= PATTERN_COUNT)
+        return 0;
+
+    pattern_level (pattern40, H40_COUNT, &pm->h40_high[id], &pm->h40_low[id]);
+    pattern_level (pattern14, H14_COUNT, &pm->h14_high[id], &pm->h14_low[id]);
+    pm->read |= 1u << id;
+
+    // expected high but not high, expected low but not low.
+    fail40 = pm->h40_used & ((pm->h40[id] & ~pm->h40_high[id]) | (~pm->h40[id] & ~pm->h40_low[id]));
+    fail14 = pm->h14_used & ((pm->h14[id] & ~pm->h14_high[id]) | (~pm->h14[id] & ~pm->h14_low[id]));
+
+    if (fail40 | fail14)
+        printf ("PT%d FAIL - J2 : 0x%010llx, J3 : 0x%04llx\n", id, fail40, fail14);
+
+    return __builtin_popcountll (fail40) + __builtin_popcountll (fail14);
+}
+
+//------------------------------------------------------------------------------
+// fault : eHEADER_STUCK_LOW, eHEADER_STUCK_HIGH, eHEADER_SHORT, eHEADER_FAULT
+// str   : pin list of the fault ("3,5,J3.13", short : "3=5 7=8=12")
+// return : failing pin count of the fault (0 = pass, -1 = patterns not read)
+//------------------------------------------------------------------------------
+int header_pattern_check (int fault, char *str, int size)
+{
+    struct header_mask *pm = &HeaderMask;
+    struct header_line *pl, *pn;
+    unsigned int high[H40_COUNT + H14_COUNT], low[H40_COUNT + H14_COUNT];
+    int type[H40_COUNT + H14_COUNT], shown[H40_COUNT + H14_COUNT];
+    int i, j, cnt = 0, len = 0, group;
+
+    if (str)    memset (str, 0, size);
+
+    if (pm->read != CODE_MASK)
+        return -1;
+
+    // lines with the same failed readings : one net (short)
+    for (i = 0; i < pm->line_cnt; i++) {
+        type[i]  = line_fault (pm, &pm->line[i], &high[i], &low[i]);
+        shown[i] = 0;
+    }
+    for (i = 0; i < pm->line_cnt; i++) {
+        if (type[i] != eHEADER_FAULT)
+            continue;
+        for (j = i + 1; j < pm->line_cnt; j++) {
+            if ((type[j] == eHEADER_FAULT || type[j] == eHEADER_SHORT) &&
+                (high[i] == high[j]) && (low[i] == low[j]))
+                type[i] = type[j] = eHEADER_SHORT;
+        }
+    }
+
+    for (i = 0; i < pm->line_cnt; i++) {
+        pl = &pm->line[i];
+        if ((type[i] != fault) || shown[i])
+            continue;
+
+        if (fault != eHEADER_SHORT) {
+            cnt++;
+            if (str)    len += line_str (&str[len], size - len, pl, cnt > 1 ? "," : "");
+            continue;
         }
-        for (i = 0; i < (int)(sizeof(HEADER40)/sizeof(int)); i++) {
-            if (HEADER40[i]) {
-                if (H40_PATTERN[id][i]){
-                    if (pattern40[i] < 3000) {
-                        printf ("PT%d GPIO - %d : %d %dmV\n",
-                            id, HEADER40[i], H40_PATTERN[id][i], pattern40[i]);
-                        return 0;
-                    }
-                } else {
-                    if (pattern40[i] > 300) {
-                        printf ("PT%d GPIO - %d : %d %dmV\n",
-                            id, HEADER40[i], H40_PATTERN[id][i], pattern40[i]);
-                        return 0;
-                    }
-                }
-            }
+        // short group : "3=5=7"
+        for (j = i, group = 0; j < pm->line_cnt; j++) {
+            pn = &pm->line[j];
+            if ((type[j] != eHEADER_SHORT) || (high[i] != high[j]) || (low[i] != low[j]))
+                continue;
+            shown[j] = 1;   cnt++;
+            if (str)
+                len += line_str (&str[len], size - len, pn, group++ ? "=" : (len ? " " : ""));
         }
     }
-    return 1;
+    return cnt;
 }
 
 //------------------------------------------------------------------------------
@@ -320,14 +499,19 @@ int header_init (void)
 {
     int i;
 
-    for (i = 0; i < (int)(sizeof(HEADER14)/sizeof(int)); i++) {
+    pattern_compile (&HeaderMask);
+    printf ("%s : %d lines, %d patterns\n", __func__, HeaderMask.line_cnt, PATTERN_COUNT);
+    if (cdev_init (&HeaderCdev))
+        return 1;
+
+    for (i = 0; i < H14_COUNT; i++) {
         if (HEADER14[i]) {
             gpio_export    (HEADER14[i]);
             gpio_direction (HEADER14[i], GPIO_DIR_OUT);
         }
     }
 
-    for (i = 0; i < (int)(sizeof(HEADER40)/sizeof(int)); i++) {
+    for (i = 0; i < H40_COUNT; i++) {
         if (HEADER40[i]) {
             gpio_export    (HEADER40[i]);
             gpio_direction (HEADER40[i], GPIO_DIR_OUT);
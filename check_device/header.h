@@ -18,21 +18,25 @@
 
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
-// Define the Device ID for the HEADER group.
+// Define the Device ID for the HEADER group. (fault type of the header pins)
 //------------------------------------------------------------------------------
 enum {
-    eHEADER_PATTERN1,
-    eHEADER_PATTERN2,
-    eHEADER_PATTERN3,
-    eHEADER_PATTERN4,
+    eHEADER_STUCK_LOW,      // open, short to GND
+    eHEADER_STUCK_HIGH,     // short to power
+    eHEADER_SHORT,          // pin to pin short
+    eHEADER_FAULT,          // level error (not stuck, not short)
     eHEADER_END
 };
 
+// constant weight code patterns (13 bits, 8 bits set : max 26 lines)
+#define HEADER_PATTERN_COUNT    13
+
 //------------------------------------------------------------------------------
 // function prototype
 //------------------------------------------------------------------------------
 extern int header_pattern_set   (int id);
-extern int header_pattern_check (int id, int *pattern40, int *pattern14);
+extern int header_pattern_read  (int id, int *pattern40, int *pattern14);
+extern int header_pattern_check (int fault, char *str, int size);
 extern int header_init          (void);
 
 //------------------------------------------------------------------------------
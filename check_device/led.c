@@ -34,6 +34,7 @@
 
 //------------------------------------------------------------------------------
 #include "led.h"
+#include "sysfs.h"
 
 //------------------------------------------------------------------------------
 struct device_led {
@@ -66,15 +67,9 @@ const char *ALIVE_TRIGGER = "/sys/class/leds/blue/trigger";
 static int led_read (const char *path)
 {
     char rdata[16];
-    FILE *fp;
-
-    memset (rdata, 0, sizeof (rdata));
 
     // led value get
-    if ((fp = fopen(path, "r")) != NULL) {
-        fread (rdata, 1, sizeof(rdata), fp);
-        fclose(fp);
-    }
+    sysfs_read_str (path, rdata, sizeof(rdata));
 
     return atoi(rdata);
 }
@@ -82,28 +77,19 @@ static int led_read (const char *path)
 //------------------------------------------------------------------------------
 static int led_write (const char *path, const char *wdata)
 {
-    FILE *fp;
-
     // led value set
-    if ((fp = fopen(path, "w")) != NULL) {
-        fwrite (wdata, 1, strlen(wdata), fp);
-        fclose(fp);
-    }
-
-    return atoi(wdata);
+    return sysfs_write (path, wdata);
 }
 
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
 int led_set_status (int id, int onoff)
 {
-    if ((id >= eLED_END) || (access (DeviceLED[id].path, R_OK) != 0)) {
+    if (id >= eLED_END) {
         return 0;
     }
 
-    led_write (DeviceLED[id].path, onoff ? DeviceLED[id].set : DeviceLED[id].clr);
-
-    return 1;
+    return led_write (DeviceLED[id].path, onoff ? DeviceLED[id].set : DeviceLED[id].clr);
 }
 
 //------------------------------------------------------------------------------
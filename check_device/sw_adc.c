@@ -0,0 +1,220 @@
+//------------------------------------------------------------------------------
+/**
+ * @file sw_adc.c
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG.
+ * @version 0.2
+ * @date 2023-10-12
+ *
+ * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+//------------------------------------------------------------------------------
+#include "sw_adc.h"
+#include "sysfs.h"
+
+//------------------------------------------------------------------------------
+//
+// Boot switch ADC (SARADC ch0).
+// IIO triggered buffer (hrtimer trigger) : the samples are read from the IIO
+// character device in a batch, a switch change is seen within one sample
+// period. sysfs in_voltage0_raw (sysfs attribute cache) if the buffer is not
+// available.
+//
+//------------------------------------------------------------------------------
+#define IIO_DEVICE      "iio:device0"
+#define IIO_SYSFS_PATH  "/sys/bus/iio/devices/" IIO_DEVICE
+#define IIO_DEV_PATH    "/dev/" IIO_DEVICE
+#define IIO_RAW_PATH    IIO_SYSFS_PATH "/in_voltage0_raw"
+
+// hrtimer trigger (configfs), sample rate (Hz), buffer length (samples)
+#define IIO_TRIG_NAME   "jig-sw-adc"
+#define IIO_TRIG_CONFIG "/sys/kernel/config/iio/triggers/hrtimer/" IIO_TRIG_NAME
+#define IIO_TRIG_PATH   "/sys/bus/iio/devices"
+#define IIO_SAMPLE_HZ   "100"
+#define IIO_BUF_LENGTH  "64"
+
+#define SAMPLE_MAX      32
+
+struct sw_adc {
+    // 1 : buffered, 0 : sysfs raw
+    int init, buffered, fd;
+    // scan element format (in_voltage0_type : "le:u12/16>>0")
+    int be, bits, bytes, shift;
+};
+
+static struct sw_adc SwAdc = { 0, 0, -1, 0, 0, 0, 0 };
+
+//------------------------------------------------------------------------------
+// sampling_frequency of the trigger named IIO_TRIG_NAME
+//------------------------------------------------------------------------------
+static int iio_trigger_setup (void)
+{
+    DIR *dir;
+    struct dirent *d;
+    char path[256], name[64];
+    int found = 0;
+
+    // already created : EEXIST
+    if (mkdir (IIO_TRIG_CONFIG, 0755) && (errno != EEXIST))
+        return 0;
+
+    if ((dir = opendir (IIO_TRIG_PATH)) == NULL)
+        return 0;
+
+    while (!found && ((d = readdir (dir)) != NULL)) {
+        if (strncmp (d->d_name, "trigger", 7))
+            continue;
+        snprintf (path, sizeof(path), "%s/%s/name", IIO_TRIG_PATH, d->d_name);
+        if (!sysfs_read_str (path, name, sizeof(name)) || strncmp (name, IIO_TRIG_NAME, strlen (IIO_TRIG_NAME)))
+            continue;
+        snprintf (path, sizeof(path), "%s/%s/sampling_frequency", IIO_TRIG_PATH, d->d_name);
+        found = sysfs_write (path, IIO_SAMPLE_HZ);
+    }
+    closedir (dir);
+    return found;
+}
+
+//------------------------------------------------------------------------------
+static int iio_buffer_setup (struct sw_adc *ps)
+{
+    DIR *dir;
+    struct dirent *d;
+    char path[256], type[32], endian[4];
+    int storage;
+
+    sysfs_write (IIO_SYSFS_PATH "/buffer/enable", "0");
+
+    if (!iio_trigger_setup () ||
+        !sysfs_write (IIO_SYSFS_PATH "/trigger/current_trigger", IIO_TRIG_NAME))
+        return 0;
+
+    // in_voltage0 only
+    if ((dir = opendir (IIO_SYSFS_PATH "/scan_elements")) == NULL)
+        return 0;
+    while ((d = readdir (dir)) != NULL) {
+        if (!strstr (d->d_name, "_en"))
+            continue;
+        snprintf (path, sizeof(path), "%s/scan_elements/%s", IIO_SYSFS_PATH, d->d_name);
+        sysfs_write (path, strcmp (d->d_name, "in_voltage0_en") ? "0" : "1");
+    }
+    closedir (dir);
+
+    if (!sysfs_read_str (IIO_SYSFS_PATH "/scan_elements/in_voltage0_type", type, sizeof(type)))
+        return 0;
+    if (sscanf (type, "%2s:%*c%d/%d>>%d", endian, &ps->bits, &storage, &ps->shift) != 4)
+        return 0;
+    ps->be    = !strcmp (endian, "be");
+    ps->bytes = storage / 8;
+    if ((ps->bytes != 1) && (ps->bytes != 2) && (ps->bytes != 4))
+        return 0;
+
+    if (!sysfs_write (IIO_SYSFS_PATH "/buffer/length", IIO_BUF_LENGTH) ||
+        !sysfs_write (IIO_SYSFS_PATH "/buffer/enable", "1"))
+        return 0;
+
+    return ((ps->fd = open (IIO_DEV_PATH, O_RDONLY | O_NONBLOCK)) >= 0);
+}
+
+//------------------------------------------------------------------------------
+// buffer off, trigger detached and removed. (raw read needs the buffer off)
+//------------------------------------------------------------------------------
+static void iio_buffer_teardown (struct sw_adc *ps)
+{
+    if (ps->fd >= 0) {
+        close (ps->fd);     ps->fd = -1;
+    }
+    sysfs_write (IIO_SYSFS_PATH "/buffer/enable", "0");
+    sysfs_write (IIO_SYSFS_PATH "/trigger/current_trigger", "\n");
+    rmdir (IIO_TRIG_CONFIG);
+}
+
+//------------------------------------------------------------------------------
+static int iio_sample (struct sw_adc *ps, const unsigned char *p)
+{
+    unsigned int raw = 0;
+    int i;
+
+    for (i = 0; i < ps->bytes; i++)
+        raw |= (unsigned int)p[ps->be ? i : (ps->bytes - 1 - i)] << ((ps->bytes - 1 - i) * 8);
+
+    return (raw >> ps->shift) & ((1u << ps->bits) -1);
+}
+
+//------------------------------------------------------------------------------
+// return : 1 buffered capture, 0 sysfs raw
+//------------------------------------------------------------------------------
+int sw_adc_init (void)
+{
+    struct sw_adc *ps = &SwAdc;
+
+    if (ps->init)
+        return ps->buffered;
+
+    ps->init = 1;
+    if ((ps->buffered = iio_buffer_setup (ps)))
+        return 1;
+
+    iio_buffer_teardown (ps);
+    printf ("%s : iio buffer not available, use %s\n", __func__, IIO_RAW_PATH);
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+// emmc : 1380 - 1390 - 1400
+// sd : 680 - 690 - 700
+// return : latest adc raw value within timeout_ms, -1 if no sample.
+//------------------------------------------------------------------------------
+int sw_adc_read (int timeout_ms)
+{
+    struct sw_adc *ps = &SwAdc;
+    unsigned char buf[SAMPLE_MAX * 4];
+    struct pollfd pfd;
+    char rdata[16];
+    int len, value = -1;
+
+    if (!sw_adc_init ()) {
+        usleep (timeout_ms * 1000);
+        if (!sysfs_read_str (IIO_RAW_PATH, rdata, sizeof(rdata)))
+            return -1;
+        return atoi (rdata);
+    }
+
+    pfd.fd = ps->fd;    pfd.events = POLLIN;    pfd.revents = 0;
+    if (poll (&pfd, 1, timeout_ms) <= 0)
+        return -1;
+
+    // drain the buffer, the last sample is the latest.
+    while ((len = read (ps->fd, buf, ps->bytes * SAMPLE_MAX)) >= ps->bytes)
+        value = iio_sample (ps, &buf[(len / ps->bytes - 1) * ps->bytes]);
+    return value;
+}
+
+//------------------------------------------------------------------------------
+// end of the test : the buffer and trigger are not left for the next run.
+//------------------------------------------------------------------------------
+void sw_adc_close (void)
+{
+    struct sw_adc *ps = &SwAdc;
+
+    if (ps->init && ps->buffered)
+        iio_buffer_teardown (ps);
+    ps->init = ps->buffered = 0;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,30 @@
+//------------------------------------------------------------------------------
+/**
+ * @file sw_adc.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG.
+ * @version 0.2
+ * @date 2023-10-12
+ *
+ * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __SW_ADC_H__
+#define __SW_ADC_H__
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+extern int sw_adc_init (void);
+extern int sw_adc_read (int timeout_ms);
+extern void sw_adc_close (void);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __SW_ADC_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
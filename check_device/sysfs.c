@@ -0,0 +1,164 @@
+//------------------------------------------------------------------------------
+/**
+ * @file sysfs.c
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG.
+ * @version 0.2
+ * @date 2023-10-12
+ *
+ * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+
+//------------------------------------------------------------------------------
+#include "sysfs.h"
+
+//------------------------------------------------------------------------------
+//
+// sysfs attribute cache.
+// Each attribute is opened once and read/written with pread/pwrite at offset 0
+// (sysfs regenerates the value on every read from offset 0).
+// An attribute that fails (device removed, link down) is closed and reopened
+// once, so a re-plugged device gets a fresh node.
+//
+//------------------------------------------------------------------------------
+#define STR_PATH_LENGTH 128
+#define SYSFS_ATTR_MAX  64
+
+struct sysfs_attr {
+    char    path[STR_PATH_LENGTH];
+    int     fd;
+    pthread_mutex_t lock;
+};
+
+static struct sysfs_attr SysfsAttr[SYSFS_ATTR_MAX];
+static int SysfsAttrCount = 0;
+static pthread_mutex_t SysfsLock = PTHREAD_MUTEX_INITIALIZER;
+
+// open / pread / pwrite call counters
+static unsigned int SysfsOpens = 0, SysfsReads = 0, SysfsWrites = 0;
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+static int sysfs_open (const char *path)
+{
+    int fd;
+
+    __atomic_add_fetch (&SysfsOpens, 1, __ATOMIC_RELAXED);
+    // write-only attributes (e.g. unexport) fail O_RDWR.
+    if ((fd = open (path, O_RDWR | O_CLOEXEC)) < 0)
+        if ((fd = open (path, O_RDONLY | O_CLOEXEC)) < 0)
+            fd = open (path, O_WRONLY | O_CLOEXEC);
+    return fd;
+}
+
+//------------------------------------------------------------------------------
+// return : cached attribute, NULL if the table is full (caller uses a
+// temporary fd).
+//------------------------------------------------------------------------------
+static struct sysfs_attr *sysfs_attr (const char *path)
+{
+    struct sysfs_attr *pa = NULL;
+    int i;
+
+    pthread_mutex_lock (&SysfsLock);
+    for (i = 0; i < SysfsAttrCount; i++) {
+        if (!strcmp (SysfsAttr[i].path, path)) {
+            pa = &SysfsAttr[i];
+            break;
+        }
+    }
+    if ((pa == NULL) && (SysfsAttrCount < SYSFS_ATTR_MAX) &&
+        (strlen (path) < STR_PATH_LENGTH)) {
+        pa = &SysfsAttr[SysfsAttrCount++];
+        strcpy (pa->path, path);
+        pa->fd = -1;
+        pthread_mutex_init (&pa->lock, NULL);
+    }
+    pthread_mutex_unlock (&SysfsLock);
+    return pa;
+}
+
+//------------------------------------------------------------------------------
+// return : bytes transferred, -1 on error. wdata == NULL : read.
+//------------------------------------------------------------------------------
+static int sysfs_xfer (const char *path, void *rdata, const char *wdata, int size)
+{
+    struct sysfs_attr *pa;
+    int fd, retry, ret = -1;
+
+    if ((pa = sysfs_attr (path)) == NULL) {
+        if ((fd = sysfs_open (path)) < 0)
+            return -1;
+        ret = wdata ? pwrite (fd, wdata, size, 0) : pread (fd, rdata, size, 0);
+        close (fd);
+        return ret;
+    }
+
+    pthread_mutex_lock (&pa->lock);
+    for (retry = 0; retry < 2; retry++) {
+        if ((pa->fd < 0) && ((pa->fd = sysfs_open (path)) < 0))
+            break;
+        if (wdata) {
+            __atomic_add_fetch (&SysfsWrites, 1, __ATOMIC_RELAXED);
+            ret = pwrite (pa->fd, wdata, size, 0);
+        } else {
+            __atomic_add_fetch (&SysfsReads, 1, __ATOMIC_RELAXED);
+            ret = pread (pa->fd, rdata, size, 0);
+        }
+        if (ret >= 0)
+            break;
+        close (pa->fd);     pa->fd = -1;
+    }
+    pthread_mutex_unlock (&pa->lock);
+    return ret;
+}
+
+//------------------------------------------------------------------------------
+// raw bytes (binary attribute, e.g. edid). return : bytes read, -1 on error.
+//------------------------------------------------------------------------------
+int sysfs_read (const char *path, void *rdata, int size)
+{
+    return sysfs_xfer (path, rdata, NULL, size);
+}
+
+//------------------------------------------------------------------------------
+// text attribute, rdata is always null-terminated. return : 1 success.
+//------------------------------------------------------------------------------
+int sysfs_read_str (const char *path, char *rdata, int size)
+{
+    memset (rdata, 0, size);
+    return (sysfs_xfer (path, rdata, NULL, size -1) > 0);
+}
+
+//------------------------------------------------------------------------------
+// return : 1 success.
+//------------------------------------------------------------------------------
+int sysfs_write (const char *path, const char *wdata)
+{
+    int len = strlen (wdata);
+
+    return (sysfs_xfer (path, NULL, wdata, len) == len);
+}
+
+//------------------------------------------------------------------------------
+void sysfs_stats (unsigned int *opens, unsigned int *reads, unsigned int *writes)
+{
+    *opens  = __atomic_load_n (&SysfsOpens,  __ATOMIC_RELAXED);
+    *reads  = __atomic_load_n (&SysfsReads,  __ATOMIC_RELAXED);
+    *writes = __atomic_load_n (&SysfsWrites, __ATOMIC_RELAXED);
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,31 @@
+//------------------------------------------------------------------------------
+/**
+ * @file sysfs.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG.
+ * @version 0.2
+ * @date 2023-10-12
+ *
+ * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __SYSFS_H__
+#define __SYSFS_H__
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+extern int  sysfs_read      (const char *path, void *rdata, int size);
+extern int  sysfs_read_str  (const char *path, char *rdata, int size);
+extern int  sysfs_write     (const char *path, const char *wdata);
+extern void sysfs_stats     (unsigned int *opens, unsigned int *reads, unsigned int *writes);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __SYSFS_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -19,10 +19,12 @@
 #include <string.h>
 #include <limits.h>
 #include <unistd.h>
+#include <dirent.h>
 #include <sys/sysinfo.h>
 
 //------------------------------------------------------------------------------
 #include "system.h"
+#include "sysfs.h"
 
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
@@ -52,6 +54,9 @@ struct device_system {
 #define DEFAULT_RES_X   1920
 #define DEFAULT_RES_Y   1080
 
+// DRM connector (cardN-HDMI-A-1 ...), used if no fbdev.
+#define DRM_SYSFS_PATH  "/sys/class/drm"
+
 static struct device_system DeviceSYSTEM = {
     DEFAULT_RES_X, DEFAULT_RES_Y, "/sys/class/graphics/fb0/virtual_size", 0, 0, 0
 };
@@ -84,24 +89,17 @@ static int get_memory_size (void)
 //------------------------------------------------------------------------------
 static int get_fb_size (const char *path, int id)
 {
-    FILE *fp;
-    int x, y;
-
-    if (access (path, R_OK) == 0) {
-        if ((fp = fopen(path, "r")) != NULL) {
-            char rdata[16], *ptr;
+    char rdata[16], *ptr;
+    int x = 0, y = 0;
 
-            memset (rdata, 0x00, sizeof(rdata));
+    // virtual_size : "1920,1080"
+    if (sysfs_read_str (path, rdata, sizeof(rdata))) {
+        if ((ptr = strtok (rdata, ",")) != NULL)
+            x = atoi(ptr);
 
-            if (fgets (rdata, sizeof(rdata), fp) != NULL) {
-                if ((ptr = strtok (rdata, ",")) != NULL)
-                    x = atoi(ptr);
+        if ((ptr = strtok (NULL, ",")) != NULL)
+            y = atoi(ptr);
 
-                if ((ptr = strtok (NULL, ",")) != NULL)
-                    y = atoi(ptr);
-            }
-            fclose(fp);
-        }
         switch (id) {
             case eSYSTEM_FB_X:  return x;
             case eSYSTEM_FB_Y:  return y;
@@ -111,6 +109,49 @@ static int get_fb_size (const char *path, int id)
     return 0;
 }
 
+//------------------------------------------------------------------------------
+// connected connector, first(preferred) mode "1920x1080"
+//------------------------------------------------------------------------------
+static int get_drm_size (int id)
+{
+    DIR *dir;
+    struct dirent *d;
+    FILE *fp;
+    char path[STR_PATH_LENGTH +1], rdata[32];
+    int x = 0, y = 0;
+
+    if ((dir = opendir (DRM_SYSFS_PATH)) == NULL)
+        return 0;
+
+    while (!x && ((d = readdir (dir)) != NULL)) {
+        if (strncmp (d->d_name, "card", 4) || !strchr (d->d_name, '-'))
+            continue;
+
+        snprintf (path, sizeof(path), "%s/%s/status", DRM_SYSFS_PATH, d->d_name);
+        if ((fp = fopen (path, "r")) == NULL)
+            continue;
+        memset (rdata, 0x00, sizeof(rdata));
+        if ((fgets (rdata, sizeof(rdata), fp) == NULL) || strncmp (rdata, "connected", 9)) {
+            fclose (fp);    continue;
+        }
+        fclose (fp);
+
+        snprintf (path, sizeof(path), "%s/%s/modes", DRM_SYSFS_PATH, d->d_name);
+        if ((fp = fopen (path, "r")) == NULL)
+            continue;
+        if ((fgets (rdata, sizeof(rdata), fp) == NULL) || (sscanf (rdata, "%dx%d", &x, &y) != 2))
+            x = y = 0;
+        fclose (fp);
+    }
+    closedir (dir);
+
+    switch (id) {
+        case eSYSTEM_FB_X:  return x;
+        case eSYSTEM_FB_Y:  return y;
+        default :           return 0;
+    }
+}
+
 //------------------------------------------------------------------------------
 int system_check (int id)
 {
@@ -118,10 +159,10 @@ int system_check (int id)
         case eSYSTEM_MEM:
             return get_memory_size();
         case eSYSTEM_FB_X:  case eSYSTEM_FB_Y:
-
-            if (access (DeviceSYSTEM.fb_path, R_OK) == 0)
-                return  get_fb_size (DeviceSYSTEM.fb_path, id);
-            return 0;
+            {
+                int size = get_fb_size (DeviceSYSTEM.fb_path, id);
+                return size ? size : get_drm_size (id);
+            }
         default :
             break;
     }
@@ -23,6 +23,7 @@
 
 //------------------------------------------------------------------------------
 #include "usb.h"
+#include "sysfs.h"
 
 //------------------------------------------------------------------------------
 #define STR_PATH_LENGTH 128
@@ -73,19 +74,13 @@ struct device_usb DeviceUSB [eUSB_END] = {
 //------------------------------------------------------------------------------
 static int usb_speed (const char *path)
 {
-    FILE *fp;
     char cmd[STR_PATH_LENGTH], rdata[STR_PATH_LENGTH];
 
-    if (access (path, R_OK) == 0) {
-        memset  (cmd, 0x00, sizeof(cmd));
-        sprintf (cmd, "%s/speed", path);
-        if ((fp = fopen (cmd, "r")) != NULL) {
-            memset (rdata, 0, sizeof(rdata));
-            fgets  (rdata, sizeof(rdata), fp);
-            fclose (fp);
-        }
+    // device not connected : no speed attribute
+    memset  (cmd, 0x00, sizeof(cmd));
+    sprintf (cmd, "%s/speed", path);
+    if (sysfs_read_str (cmd, rdata, sizeof(rdata)))
         return atoi (rdata);
-    }
     return 0;
 }
 
@@ -0,0 +1,518 @@
+//------------------------------------------------------------------------------
+/**
+ * @file fb_stream.c
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Remote framebuffer streaming(tile delta) for ODROID-JIG.
+ * @version 0.2
+ * @date 2024-07-15
+ *
+ * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <pthread.h>
+#include <time.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <linux/fb.h>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+//------------------------------------------------------------------------------
+#include "fb_stream.h"
+
+//------------------------------------------------------------------------------
+//
+// Configuration
+//
+//------------------------------------------------------------------------------
+#define FB_STREAM_TILE      64
+
+// cpu time limit of the stream thread (%), scan interval, reconnect delay (ms)
+#define FB_STREAM_CPU_PCT   5
+#define FB_STREAM_INTERVAL  250
+#define FB_STREAM_RETRY     3000
+
+// stream thread runs on the little cores (cpu0 ~ 3, benchmarks use big cores)
+#define FB_STREAM_CPU_START 0
+#define FB_STREAM_CPU_END   4
+
+#define IP_STR_LENGTH       20
+
+// FNV-1a
+#define FNV_OFFSET          2166136261u
+#define FNV_PRIME           16777619u
+
+//------------------------------------------------------------------------------
+// Pixel kernels (scalar, NEON), selected by the cpu hwcap in stream_open().
+// hash  : 4 lanes FNV-1a of the 16 bytes blocks (len : multiple of 16)
+// run32 : count of the 32bpp pixels equal to pix from line (max n)
+//------------------------------------------------------------------------------
+struct stream_kernel {
+    const char *name;
+    void (*hash)  (unsigned int *lane, const unsigned char *line, int len);
+    int  (*run32) (const unsigned char *line, unsigned int pix, int n);
+};
+
+struct fb_stream {
+    char ip[IP_STR_LENGTH];
+    int  port, fd, sock;
+
+    struct fb_var_screeninfo var;
+    struct fb_fix_screeninfo fix;
+    unsigned char *base;
+    int bytes, tiles_x, tiles_y;
+
+    // tile hash (sent), changed tile list
+    unsigned int *hash, *next;
+    unsigned short *changed;
+
+    // rle buffer of one tile
+    unsigned char *rle;
+    pthread_t thread;
+
+    const struct stream_kernel *k;
+};
+
+static struct fb_stream FbStream;
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+static unsigned long stream_cpu_us (void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+//------------------------------------------------------------------------------
+static void stream_tile_rect (struct fb_stream *ps, int t, int *x, int *y, int *w, int *h)
+{
+    *x = (t % ps->tiles_x) * FB_STREAM_TILE;
+    *y = (t / ps->tiles_x) * FB_STREAM_TILE;
+    *w = ((*x + FB_STREAM_TILE) > (int)ps->var.xres) ? (int)ps->var.xres - *x : FB_STREAM_TILE;
+    *h = ((*y + FB_STREAM_TILE) > (int)ps->var.yres) ? (int)ps->var.yres - *y : FB_STREAM_TILE;
+}
+
+//------------------------------------------------------------------------------
+static unsigned char *stream_line (struct fb_stream *ps, int x, int y)
+{
+    return ps->base + (y + ps->var.yoffset) * ps->fix.line_length +
+                      (x + ps->var.xoffset) * ps->bytes;
+}
+
+//------------------------------------------------------------------------------
+static void hash_c (unsigned int *lane, const unsigned char *line, int len)
+{
+    unsigned int v[4];
+    int i;
+
+    for (i = 0; i < len; i += 16) {
+        memcpy (v, line + i, 16);
+        lane[0] = (lane[0] ^ v[0]) * FNV_PRIME;
+        lane[1] = (lane[1] ^ v[1]) * FNV_PRIME;
+        lane[2] = (lane[2] ^ v[2]) * FNV_PRIME;
+        lane[3] = (lane[3] ^ v[3]) * FNV_PRIME;
+    }
+}
+
+//------------------------------------------------------------------------------
+static int run32_c (const unsigned char *line, unsigned int pix, int n)
+{
+    unsigned int v;
+    int i;
+
+    for (i = 0; i < n; i++) {
+        memcpy (&v, line + i * 4, 4);
+        if (v != pix)
+            break;
+    }
+    return i;
+}
+
+static const struct stream_kernel KernelC = { "scalar", hash_c, run32_c };
+
+#if defined(__aarch64__)
+//------------------------------------------------------------------------------
+static void hash_neon (unsigned int *lane, const unsigned char *line, int len)
+{
+    uint32x4_t h = vld1q_u32 (lane), prime = vdupq_n_u32 (FNV_PRIME);
+    int i;
+
+    for (i = 0; i < len; i += 16)
+        h = vmulq_u32 (veorq_u32 (h, vreinterpretq_u32_u8 (vld1q_u8 (line + i))), prime);
+    vst1q_u32 (lane, h);
+}
+
+//------------------------------------------------------------------------------
+// 4 pixels per compare, the block with a different pixel is counted by run32_c.
+//------------------------------------------------------------------------------
+static int run32_neon (const unsigned char *line, unsigned int pix, int n)
+{
+    uint32x4_t ref = vdupq_n_u32 (pix), eq;
+    int i;
+
+    for (i = 0; i + 4 <= n; i += 4) {
+        eq = vceqq_u32 (vreinterpretq_u32_u8 (vld1q_u8 (line + i * 4)), ref);
+        if (vminvq_u32 (eq) != 0xFFFFFFFFu)
+            break;
+    }
+    return i + run32_c (line + i * 4, pix, n - i);
+}
+
+static const struct stream_kernel KernelNeon = { "neon", hash_neon, run32_neon };
+#endif
+
+//------------------------------------------------------------------------------
+static const struct stream_kernel *stream_kernel (void)
+{
+#if defined(__aarch64__)
+    if (getauxval (AT_HWCAP) & HWCAP_ASIMD)
+        return &KernelNeon;
+#endif
+    return &KernelC;
+}
+
+//------------------------------------------------------------------------------
+// FNV-1a of the 4 lanes (lane n : 32 bits words n, n+4, n+8 ...)
+//------------------------------------------------------------------------------
+static unsigned int stream_tile_hash (struct fb_stream *ps, int t)
+{
+    unsigned int lane[4] = { FNV_OFFSET, FNV_OFFSET, FNV_OFFSET, FNV_OFFSET }, hash;
+    unsigned char *line;
+    int x, y, w, h, i, len, blk;
+
+    stream_tile_rect (ps, t, &x, &y, &w, &h);
+    len = w * ps->bytes;
+    blk = len & ~15;
+
+    for (; h--; y++) {
+        line = stream_line (ps, x, y);
+        ps->k->hash (lane, line, blk);
+        for (i = blk; i < len; i++)
+            lane[0] = (lane[0] ^ line[i]) * FNV_PRIME;
+    }
+    for (i = 0, hash = FNV_OFFSET; i < 4; i++)
+        hash = (hash ^ lane[i]) * FNV_PRIME;
+    return hash;
+}
+
+//------------------------------------------------------------------------------
+// run length : (count -1, pixel), max 256 pixels per run.
+//------------------------------------------------------------------------------
+static int stream_tile_rle (struct fb_stream *ps, int t, unsigned char *out)
+{
+    unsigned char *line, *run = NULL, *pix;
+    unsigned int v;
+    int x, y, w, h, i, n, cnt = 0, len = 0;
+
+    stream_tile_rect (ps, t, &x, &y, &w, &h);
+
+    for (; h--; y++) {
+        line = stream_line (ps, x, y);
+        for (i = 0; i < w; ) {
+            pix = line + i * ps->bytes;
+            if (cnt && (cnt < 256)) {
+                if (ps->bytes == 4) {
+                    memcpy (&v, run, 4);
+                    n = ps->k->run32 (pix, v, ((w - i) < (256 - cnt)) ? (w - i) : (256 - cnt));
+                } else
+                    n = memcmp (run, pix, ps->bytes) ? 0 : 1;
+                if (n) {
+                    cnt += n;   run[-1] = cnt - 1;  i += n;
+                    continue;
+                }
+            }
+            out[len++] = 0;
+            memcpy (&out[len], pix, ps->bytes);
+            run  = &out[len];
+            len += ps->bytes;
+            cnt  = 1;   i++;
+        }
+    }
+    return len;
+}
+
+//------------------------------------------------------------------------------
+static int stream_send (int sock, const void *buf, int len)
+{
+    const unsigned char *p = (const unsigned char *)buf;
+    int ret;
+
+    while (len > 0) {
+        if ((ret = send (sock, p, len, MSG_NOSIGNAL)) <= 0)
+            return 0;
+        p += ret;   len -= ret;
+    }
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+static int stream_connect (struct fb_stream *ps)
+{
+    struct sockaddr_in sa;
+    struct timeval tv = { 1, 0 };
+    int one = 1;
+
+    if ((ps->sock = socket (AF_INET, SOCK_STREAM, 0)) < 0)
+        return 0;
+
+    memset (&sa, 0, sizeof(sa));
+    sa.sin_family      = AF_INET;
+    sa.sin_port        = htons (ps->port);
+    sa.sin_addr.s_addr = inet_addr (ps->ip);
+
+    setsockopt (ps->sock, SOL_SOCKET,  SO_SNDTIMEO, &tv,  sizeof(tv));
+    setsockopt (ps->sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    if (connect (ps->sock, (struct sockaddr *)&sa, sizeof(sa))) {
+        close (ps->sock);   ps->sock = -1;
+        return 0;
+    }
+    // new viewer : all tiles are sent.
+    memset (ps->hash, 0, ps->tiles_x * ps->tiles_y * sizeof(unsigned int));
+    printf ("%s : viewer %s:%d connected.\n", __func__, ps->ip, ps->port);
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+// changed tiles of the screen. return 0 if send error.
+//------------------------------------------------------------------------------
+static int stream_frame (struct fb_stream *ps)
+{
+    unsigned char hdr[12];
+    unsigned short v16;
+    unsigned int v32;
+    int t, i, cnt = 0, x, y, w, h, len;
+
+    for (t = 0; t < ps->tiles_x * ps->tiles_y; t++) {
+        ps->next[t] = stream_tile_hash (ps, t);
+        // hash 0 : never sent
+        if (!ps->next[t])   ps->next[t] = 1;
+        if (ps->next[t] != ps->hash[t])
+            ps->changed[cnt++] = t;
+    }
+    if (!cnt)
+        return 1;
+
+    memcpy (hdr, FB_STREAM_MAGIC, 4);
+    v16 = htons (ps->var.xres); memcpy (&hdr[4], &v16, 2);
+    v16 = htons (ps->var.yres); memcpy (&hdr[6], &v16, 2);
+    hdr[8] = ps->var.bits_per_pixel;
+    hdr[9] = FB_STREAM_TILE;
+    v16 = htons (cnt);          memcpy (&hdr[10], &v16, 2);
+    if (!stream_send (ps->sock, hdr, sizeof(hdr)))
+        return 0;
+
+    for (i = 0; i < cnt; i++) {
+        t = ps->changed[i];
+        stream_tile_rect (ps, t, &x, &y, &w, &h);
+        len = stream_tile_rle (ps, t, ps->rle);
+
+        v16 = htons (x);    memcpy (&hdr[0], &v16, 2);
+        v16 = htons (y);    memcpy (&hdr[2], &v16, 2);
+        v16 = htons (w);    memcpy (&hdr[4], &v16, 2);
+        v16 = htons (h);    memcpy (&hdr[6], &v16, 2);
+        v32 = htonl (len);  memcpy (&hdr[8], &v32, 4);
+
+        if (!stream_send (ps->sock, hdr, sizeof(hdr)) || !stream_send (ps->sock, ps->rle, len))
+            return 0;
+        ps->hash[t] = ps->next[t];
+    }
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+static void *stream_thread (void *arg)
+{
+    struct fb_stream *ps = (struct fb_stream *)arg;
+    struct sched_param param = { 0 };
+    unsigned long used, sleep_ms;
+    cpu_set_t cpus;
+    int i;
+
+    // lowest priority, little cores only.
+    pthread_setschedparam (pthread_self (), SCHED_IDLE, &param);
+    CPU_ZERO (&cpus);
+    for (i = FB_STREAM_CPU_START; i < FB_STREAM_CPU_END; i++)
+        CPU_SET (i, &cpus);
+    pthread_setaffinity_np (pthread_self (), sizeof(cpu_set_t), &cpus);
+
+    while (1) {
+        if ((ps->sock < 0) && !stream_connect (ps)) {
+            usleep (FB_STREAM_RETRY * 1000);
+            continue;
+        }
+
+        used = stream_cpu_us ();
+        if (!stream_frame (ps)) {
+            printf ("%s : viewer %s disconnected.\n", __func__, ps->ip);
+            close (ps->sock);   ps->sock = -1;
+        }
+        used = stream_cpu_us () - used;
+
+        // cpu cap : used / (used + sleep) <= FB_STREAM_CPU_PCT
+        sleep_ms = (used * (100 - FB_STREAM_CPU_PCT)) / FB_STREAM_CPU_PCT / 1000;
+        if (sleep_ms < FB_STREAM_INTERVAL)
+            sleep_ms = FB_STREAM_INTERVAL;
+        usleep (sleep_ms * 1000);
+    }
+    return arg;
+}
+
+//------------------------------------------------------------------------------
+static void stream_close (struct fb_stream *ps)
+{
+    if (ps->base && (ps->base != MAP_FAILED))
+        munmap (ps->base, ps->fix.smem_len);
+    free (ps->hash);    free (ps->next);
+    free (ps->changed); free (ps->rle);
+    if (ps->fd >= 0)
+        close (ps->fd);
+    ps->base = NULL;    ps->hash = ps->next = NULL;
+    ps->changed = NULL; ps->rle = NULL;
+    ps->fd = -1;
+}
+
+//------------------------------------------------------------------------------
+// fb mmap, tile tables, pixel kernel. return 0 on error.
+//------------------------------------------------------------------------------
+static int stream_open (struct fb_stream *ps, const char *fb_dev)
+{
+    int tiles;
+
+    if ((ps->fd = open (fb_dev, O_RDONLY)) < 0)
+        return 0;
+
+    if (ioctl (ps->fd, FBIOGET_VSCREENINFO, &ps->var) ||
+        ioctl (ps->fd, FBIOGET_FSCREENINFO, &ps->fix))
+        goto err_out;
+
+    ps->bytes = ps->var.bits_per_pixel / 8;
+    if ((ps->bytes < 2) || (ps->bytes > 4))
+        goto err_out;
+
+    ps->base = mmap (NULL, ps->fix.smem_len, PROT_READ, MAP_SHARED, ps->fd, 0);
+    if (ps->base == MAP_FAILED)
+        goto err_out;
+
+    ps->tiles_x = (ps->var.xres + FB_STREAM_TILE -1) / FB_STREAM_TILE;
+    ps->tiles_y = (ps->var.yres + FB_STREAM_TILE -1) / FB_STREAM_TILE;
+    tiles = ps->tiles_x * ps->tiles_y;
+
+    ps->hash    = calloc (tiles, sizeof(unsigned int));
+    ps->next    = calloc (tiles, sizeof(unsigned int));
+    ps->changed = calloc (tiles, sizeof(unsigned short));
+    // worst case : no run (1 + pixel bytes)
+    ps->rle     = malloc (FB_STREAM_TILE * FB_STREAM_TILE * (1 + ps->bytes));
+
+    if (!ps->hash || !ps->next || !ps->changed || !ps->rle)
+        goto err_out;
+
+    ps->k = stream_kernel ();
+    return 1;
+
+err_out:
+    printf ("%s : %s stream init error.\n", __func__, fb_dev);
+    stream_close (ps);
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+// viewer : "ip" or "ip:port" (default FB_STREAM_PORT)
+//------------------------------------------------------------------------------
+int fb_stream_start (const char *fb_dev, const char *viewer)
+{
+    struct fb_stream *ps = &FbStream;
+    char *port;
+
+    memset (ps, 0, sizeof(struct fb_stream));
+    strncpy (ps->ip, viewer, IP_STR_LENGTH -1);
+    ps->port = FB_STREAM_PORT;
+    ps->sock = -1;
+    ps->fd   = -1;
+    if ((port = strchr (ps->ip, ':')) != NULL) {
+        *port = 0;  ps->port = atoi (port + 1);
+    }
+
+    if (!stream_open (ps, fb_dev))
+        return 0;
+
+    if (pthread_create (&ps->thread, NULL, stream_thread, ps)) {
+        stream_close (ps);
+        return 0;
+    }
+
+    printf ("%s : %s -> %s:%d (%dx%d tiles, %s)\n", __func__,
+            fb_dev, ps->ip, ps->port, ps->tiles_x, ps->tiles_y, ps->k->name);
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+// full screen scan (hash + rle of every tile), scalar vs selected kernel.
+//------------------------------------------------------------------------------
+int fb_stream_bench (const char *fb_dev, int frames)
+{
+    const struct stream_kernel *kernel[2];
+    struct fb_stream *ps;
+    struct timespec ts;
+    unsigned long start, us[2], bytes = 0;
+    unsigned int sum = 0;
+    int k, f, t;
+
+    if ((ps = calloc (1, sizeof(struct fb_stream))) == NULL)
+        return 0;
+
+    ps->fd = -1;
+    if ((frames <= 0) || !stream_open (ps, fb_dev)) {
+        free (ps);
+        return 0;
+    }
+    kernel[0] = &KernelC;   kernel[1] = ps->k;
+
+    for (k = 0; k < 2; k++) {
+        ps->k = kernel[k];
+        clock_gettime (CLOCK_MONOTONIC, &ts);
+        start = ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+        for (f = 0; f < frames; f++) {
+            for (t = 0; t < ps->tiles_x * ps->tiles_y; t++) {
+                sum   += stream_tile_hash (ps, t);
+                bytes += stream_tile_rle  (ps, t, ps->rle);
+            }
+        }
+        clock_gettime (CLOCK_MONOTONIC, &ts);
+        us[k] = ts.tv_sec * 1000000 + ts.tv_nsec / 1000 - start;
+    }
+
+    printf ("%s : %dx%d %dbpp, frames = %d (sum %08x)\n", __func__,
+            ps->var.xres, ps->var.yres, ps->var.bits_per_pixel, frames, sum);
+    printf ("  tile scan    : %s %lu us/frame, %s %lu us/frame, %lu rle bytes/frame\n",
+            kernel[0]->name, us[0] / frames, kernel[1]->name, us[1] / frames,
+            bytes / (2 * frames));
+
+    stream_close (ps);
+    free (ps);
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,43 @@
+//------------------------------------------------------------------------------
+/**
+ * @file fb_stream.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Remote framebuffer streaming(tile delta) for ODROID-JIG.
+ * @version 0.2
+ * @date 2024-07-15
+ *
+ * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __FB_STREAM_H__
+#define __FB_STREAM_H__
+
+//------------------------------------------------------------------------------
+// viewer(server pc) tcp port
+#define FB_STREAM_PORT  8890
+
+//------------------------------------------------------------------------------
+// Stream format (network byte order, pixel data : fb native format)
+//
+// frame : "M2FB"(4), width(2), height(2), bpp(1), tile size(1), tiles(2)
+// tile  : x(2), y(2), w(2), h(2), rle bytes(4), rle data
+// rle   : run count -1(1), pixel(bpp / 8) ...
+//
+//------------------------------------------------------------------------------
+#define FB_STREAM_MAGIC "M2FB"
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+extern int fb_stream_start (const char *fb_dev, const char *viewer);
+extern int fb_stream_bench (const char *fb_dev, int frames);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __FB_STREAM_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
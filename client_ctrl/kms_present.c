@@ -0,0 +1,503 @@
+//------------------------------------------------------------------------------
+/**
+ * @file kms_present.c
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief DRM/KMS(atomic) display output for ODROID-JIG.
+ * @version 0.2
+ * @date 2024-07-15
+ *
+ * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <linux/fb.h>
+#include <drm/drm.h>
+#include <drm/drm_mode.h>
+#include <drm/drm_fourcc.h>
+
+//------------------------------------------------------------------------------
+#include "kms_present.h"
+
+//------------------------------------------------------------------------------
+//
+// KMS presentation.
+// lib_fbui draws to the memory backed fb (vfb, fbdev api). The drawn frame
+// is copied to the back dumb buffer and shown by an atomic page flip, the
+// flip completes at the vertical blank (scanout synchronized).
+// No libdrm, kernel uapi(ioctl) only. vkms : modprobe vkms
+//
+//------------------------------------------------------------------------------
+// flip complete timeout (ms)
+#define KMS_FLIP_TIMEOUT    100
+
+#define KMS_PROP_MAX        16
+
+enum {
+    // connector
+    eKMS_CONN_CRTC_ID = 0,
+    // crtc
+    eKMS_CRTC_MODE_ID,
+    eKMS_CRTC_ACTIVE,
+    // plane
+    eKMS_PLANE_FB_ID,
+    eKMS_PLANE_CRTC_ID,
+    eKMS_PLANE_SRC_X,
+    eKMS_PLANE_SRC_Y,
+    eKMS_PLANE_SRC_W,
+    eKMS_PLANE_SRC_H,
+    eKMS_PLANE_CRTC_X,
+    eKMS_PLANE_CRTC_Y,
+    eKMS_PLANE_CRTC_W,
+    eKMS_PLANE_CRTC_H,
+    eKMS_PROP_END
+};
+
+static const char *KmsPropName[eKMS_PROP_END] = {
+    "CRTC_ID",
+    "MODE_ID", "ACTIVE",
+    "FB_ID", "CRTC_ID", "SRC_X", "SRC_Y", "SRC_W", "SRC_H",
+    "CRTC_X", "CRTC_Y", "CRTC_W", "CRTC_H",
+};
+
+struct kms_buf {
+    unsigned int handle, pitch, fb_id;
+    unsigned long size;
+    unsigned char *map;
+};
+
+struct kms_atomic {
+    unsigned int objs[KMS_PROP_MAX], count_props[KMS_PROP_MAX];
+    unsigned int props[KMS_PROP_MAX];
+    unsigned long long values[KMS_PROP_MAX];
+    int objs_cnt, props_cnt;
+};
+
+struct kms_present {
+    int fd, init;
+    unsigned int conn_id, crtc_id, plane_id, mode_blob;
+    unsigned int prop[eKMS_PROP_END];
+    struct drm_mode_modeinfo mode;
+
+    // double buffer, front : scanout buffer
+    struct kms_buf buf[2];
+    int front;
+
+    // source fb (vfb)
+    int src_fd;
+    unsigned char *src;
+    unsigned int src_w, src_h, src_pitch;
+    unsigned long src_size;
+};
+
+static struct kms_present KmsPresent = { .fd = -1, .src_fd = -1, };
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+static unsigned int kms_prop_id (int fd, unsigned int obj_id, unsigned int obj_type,
+                                 const char *name, unsigned long long *value)
+{
+    struct drm_mode_obj_get_properties op;
+    struct drm_mode_get_property gp;
+    unsigned int props[64], i, id = 0;
+    unsigned long long values[64];
+
+    memset (&op, 0, sizeof(op));
+    op.obj_id   = obj_id;
+    op.obj_type = obj_type;
+    if (ioctl (fd, DRM_IOCTL_MODE_OBJ_GETPROPERTIES, &op) || (op.count_props > 64))
+        return 0;
+
+    op.props_ptr       = (unsigned long)props;
+    op.prop_values_ptr = (unsigned long)values;
+    if (ioctl (fd, DRM_IOCTL_MODE_OBJ_GETPROPERTIES, &op))
+        return 0;
+
+    for (i = 0; i < op.count_props; i++) {
+        memset (&gp, 0, sizeof(gp));
+        gp.prop_id = props[i];
+        if (ioctl (fd, DRM_IOCTL_MODE_GETPROPERTY, &gp))
+            continue;
+        if (!strncmp (gp.name, name, DRM_PROP_NAME_LEN)) {
+            id = props[i];
+            if (value)  *value = values[i];
+            break;
+        }
+    }
+    return id;
+}
+
+//------------------------------------------------------------------------------
+// connected connector, preferred mode, crtc of the encoder.
+//------------------------------------------------------------------------------
+static int kms_find_output (struct kms_present *pk, int *crtc_index)
+{
+    struct drm_mode_card_res res;
+    struct drm_mode_get_connector conn;
+    struct drm_mode_get_encoder enc;
+    unsigned int crtcs[16], conns[16], encs[16], conn_encs[16], i, j;
+    struct drm_mode_modeinfo modes[64];
+
+    memset (&res, 0, sizeof(res));
+    if (ioctl (pk->fd, DRM_IOCTL_MODE_GETRESOURCES, &res))
+        return 0;
+    if ((res.count_crtcs > 16) || (res.count_connectors > 16) || (res.count_encoders > 16))
+        return 0;
+
+    res.count_fbs        = 0;
+    res.crtc_id_ptr      = (unsigned long)crtcs;
+    res.connector_id_ptr = (unsigned long)conns;
+    res.encoder_id_ptr   = (unsigned long)encs;
+    if (ioctl (pk->fd, DRM_IOCTL_MODE_GETRESOURCES, &res))
+        return 0;
+
+    for (i = 0; i < res.count_connectors; i++) {
+        memset (&conn, 0, sizeof(conn));
+        conn.connector_id = conns[i];
+        if (ioctl (pk->fd, DRM_IOCTL_MODE_GETCONNECTOR, &conn))
+            continue;
+        // 1 : connected
+        if ((conn.connection != 1) || !conn.count_modes)
+            continue;
+        if ((conn.count_modes > 64) || (conn.count_encoders > 16))
+            continue;
+
+        conn.count_props  = 0;
+        conn.modes_ptr    = (unsigned long)modes;
+        conn.encoders_ptr = (unsigned long)conn_encs;
+        if (ioctl (pk->fd, DRM_IOCTL_MODE_GETCONNECTOR, &conn))
+            continue;
+
+        pk->mode = modes[0];
+        for (j = 0; j < conn.count_modes; j++) {
+            if (modes[j].type & DRM_MODE_TYPE_PREFERRED) {
+                pk->mode = modes[j];    break;
+            }
+        }
+
+        memset (&enc, 0, sizeof(enc));
+        enc.encoder_id = conn.encoder_id ? conn.encoder_id : conn_encs[0];
+        if (ioctl (pk->fd, DRM_IOCTL_MODE_GETENCODER, &enc))
+            continue;
+
+        for (j = 0; j < res.count_crtcs; j++) {
+            if ((enc.crtc_id && (enc.crtc_id == crtcs[j])) ||
+                (!enc.crtc_id && (enc.possible_crtcs & (1u << j)))) {
+                pk->conn_id = conns[i];
+                pk->crtc_id = crtcs[j];
+                *crtc_index = j;
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+// primary plane of the crtc (plane "type" : 1 = primary)
+//------------------------------------------------------------------------------
+static int kms_find_plane (struct kms_present *pk, int crtc_index)
+{
+    struct drm_mode_get_plane_res res;
+    struct drm_mode_get_plane plane;
+    unsigned int planes[32], i;
+    unsigned long long type;
+
+    memset (&res, 0, sizeof(res));
+    if (ioctl (pk->fd, DRM_IOCTL_MODE_GETPLANERESOURCES, &res) || (res.count_planes > 32))
+        return 0;
+
+    res.plane_id_ptr = (unsigned long)planes;
+    if (ioctl (pk->fd, DRM_IOCTL_MODE_GETPLANERESOURCES, &res))
+        return 0;
+
+    for (i = 0; i < res.count_planes; i++) {
+        memset (&plane, 0, sizeof(plane));
+        plane.plane_id = planes[i];
+        if (ioctl (pk->fd, DRM_IOCTL_MODE_GETPLANE, &plane))
+            continue;
+        if (!(plane.possible_crtcs & (1u << crtc_index)))
+            continue;
+        if (kms_prop_id (pk->fd, planes[i], DRM_MODE_OBJECT_PLANE, "type", &type) && (type == 1)) {
+            pk->plane_id = planes[i];
+            return 1;
+        }
+    }
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+static int kms_buf_create (struct kms_present *pk, struct kms_buf *pb)
+{
+    struct drm_mode_create_dumb creq;
+    struct drm_mode_map_dumb mreq;
+    struct drm_mode_fb_cmd2 fb;
+
+    memset (&creq, 0, sizeof(creq));
+    creq.width  = pk->mode.hdisplay;
+    creq.height = pk->mode.vdisplay;
+    creq.bpp    = 32;
+    if (ioctl (pk->fd, DRM_IOCTL_MODE_CREATE_DUMB, &creq))
+        return 0;
+
+    pb->handle = creq.handle;
+    pb->pitch  = creq.pitch;
+    pb->size   = creq.size;
+
+    memset (&fb, 0, sizeof(fb));
+    fb.width        = creq.width;
+    fb.height       = creq.height;
+    fb.pixel_format = DRM_FORMAT_XRGB8888;
+    fb.handles[0]   = creq.handle;
+    fb.pitches[0]   = creq.pitch;
+    if (ioctl (pk->fd, DRM_IOCTL_MODE_ADDFB2, &fb))
+        return 0;
+    pb->fb_id = fb.fb_id;
+
+    memset (&mreq, 0, sizeof(mreq));
+    mreq.handle = creq.handle;
+    if (ioctl (pk->fd, DRM_IOCTL_MODE_MAP_DUMB, &mreq))
+        return 0;
+
+    pb->map = mmap (NULL, pb->size, PROT_READ | PROT_WRITE, MAP_SHARED, pk->fd, mreq.offset);
+    if (pb->map == MAP_FAILED) {
+        pb->map = NULL;
+        return 0;
+    }
+    memset (pb->map, 0, pb->size);
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+// properties of one object must be added in a row.
+//------------------------------------------------------------------------------
+static void kms_atomic_add (struct kms_atomic *pa, unsigned int obj,
+                            unsigned int prop, unsigned long long value)
+{
+    if (!pa->objs_cnt || (pa->objs[pa->objs_cnt -1] != obj)) {
+        pa->objs[pa->objs_cnt]        = obj;
+        pa->count_props[pa->objs_cnt] = 0;
+        pa->objs_cnt++;
+    }
+    pa->count_props[pa->objs_cnt -1]++;
+    pa->props [pa->props_cnt] = prop;
+    pa->values[pa->props_cnt] = value;
+    pa->props_cnt++;
+}
+
+//------------------------------------------------------------------------------
+static int kms_atomic_commit (struct kms_present *pk, struct kms_atomic *pa, unsigned int flags)
+{
+    struct drm_mode_atomic atomic;
+
+    memset (&atomic, 0, sizeof(atomic));
+    atomic.flags           = flags;
+    atomic.count_objs      = pa->objs_cnt;
+    atomic.objs_ptr        = (unsigned long)pa->objs;
+    atomic.count_props_ptr = (unsigned long)pa->count_props;
+    atomic.props_ptr       = (unsigned long)pa->props;
+    atomic.prop_values_ptr = (unsigned long)pa->values;
+
+    return ioctl (pk->fd, DRM_IOCTL_MODE_ATOMIC, &atomic) ? 0 : 1;
+}
+
+//------------------------------------------------------------------------------
+static int kms_wait_flip (struct kms_present *pk)
+{
+    struct pollfd pfd = { pk->fd, POLLIN, 0 };
+    char ev[256];
+    struct drm_event *pe;
+    int len, pos;
+
+    while (poll (&pfd, 1, KMS_FLIP_TIMEOUT) > 0) {
+        if ((len = read (pk->fd, ev, sizeof(ev))) <= 0)
+            return 0;
+        for (pos = 0; pos + (int)sizeof(struct drm_event) <= len; pos += pe->length) {
+            pe = (struct drm_event *)&ev[pos];
+            if (pe->type == DRM_EVENT_FLIP_COMPLETE)
+                return 1;
+            if (!pe->length)
+                break;
+        }
+    }
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+// modeset : connector -> crtc(mode) -> primary plane(buf[0])
+//------------------------------------------------------------------------------
+static int kms_modeset (struct kms_present *pk)
+{
+    struct kms_atomic a;
+    unsigned int w = pk->mode.hdisplay, h = pk->mode.vdisplay;
+
+    memset (&a, 0, sizeof(a));
+    kms_atomic_add (&a, pk->conn_id,  pk->prop[eKMS_CONN_CRTC_ID],   pk->crtc_id);
+    kms_atomic_add (&a, pk->crtc_id,  pk->prop[eKMS_CRTC_MODE_ID],   pk->mode_blob);
+    kms_atomic_add (&a, pk->crtc_id,  pk->prop[eKMS_CRTC_ACTIVE],    1);
+    kms_atomic_add (&a, pk->plane_id, pk->prop[eKMS_PLANE_FB_ID],    pk->buf[0].fb_id);
+    kms_atomic_add (&a, pk->plane_id, pk->prop[eKMS_PLANE_CRTC_ID],  pk->crtc_id);
+    // src : 16.16 fixed point
+    kms_atomic_add (&a, pk->plane_id, pk->prop[eKMS_PLANE_SRC_X],    0);
+    kms_atomic_add (&a, pk->plane_id, pk->prop[eKMS_PLANE_SRC_Y],    0);
+    kms_atomic_add (&a, pk->plane_id, pk->prop[eKMS_PLANE_SRC_W],    (unsigned long long)w << 16);
+    kms_atomic_add (&a, pk->plane_id, pk->prop[eKMS_PLANE_SRC_H],    (unsigned long long)h << 16);
+    kms_atomic_add (&a, pk->plane_id, pk->prop[eKMS_PLANE_CRTC_X],   0);
+    kms_atomic_add (&a, pk->plane_id, pk->prop[eKMS_PLANE_CRTC_Y],   0);
+    kms_atomic_add (&a, pk->plane_id, pk->prop[eKMS_PLANE_CRTC_W],   w);
+    kms_atomic_add (&a, pk->plane_id, pk->prop[eKMS_PLANE_CRTC_H],   h);
+
+    pk->front = 0;
+    return kms_atomic_commit (pk, &a, DRM_MODE_ATOMIC_ALLOW_MODESET);
+}
+
+//------------------------------------------------------------------------------
+// source fb : XRGB8888 (32 bpp)
+//------------------------------------------------------------------------------
+static int kms_src_open (struct kms_present *pk, const char *fb_dev)
+{
+    struct fb_var_screeninfo var;
+    struct fb_fix_screeninfo fix;
+
+    if ((pk->src_fd = open (fb_dev, O_RDONLY)) < 0)
+        return 0;
+
+    if (ioctl (pk->src_fd, FBIOGET_VSCREENINFO, &var) ||
+        ioctl (pk->src_fd, FBIOGET_FSCREENINFO, &fix) || (var.bits_per_pixel != 32)) {
+        printf ("%s : %s must be 32 bpp. (fbset -depth 32)\n", __func__, fb_dev);
+        return 0;
+    }
+
+    pk->src_w     = var.xres;
+    pk->src_h     = var.yres;
+    pk->src_pitch = fix.line_length;
+    pk->src_size  = fix.smem_len;
+    pk->src = mmap (NULL, pk->src_size, PROT_READ, MAP_SHARED, pk->src_fd, 0);
+    if (pk->src == MAP_FAILED) {
+        pk->src = NULL;
+        return 0;
+    }
+    // visible area
+    pk->src += var.yoffset * fix.line_length + var.xoffset * 4;
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+int kms_present_init (const char *card, const char *fb_dev)
+{
+    struct kms_present *pk = &KmsPresent;
+    struct drm_set_client_cap cap;
+    struct drm_mode_create_blob blob;
+    unsigned int obj, type;
+    int i, crtc_index = 0;
+
+    if ((pk->fd = open (card, O_RDWR | O_CLOEXEC)) < 0)
+        return 0;
+
+    cap.capability = DRM_CLIENT_CAP_UNIVERSAL_PLANES;   cap.value = 1;
+    if (ioctl (pk->fd, DRM_IOCTL_SET_CLIENT_CAP, &cap))
+        goto err_out;
+    cap.capability = DRM_CLIENT_CAP_ATOMIC;             cap.value = 1;
+    if (ioctl (pk->fd, DRM_IOCTL_SET_CLIENT_CAP, &cap)) {
+        printf ("%s : %s atomic modeset not supported.\n", __func__, card);
+        goto err_out;
+    }
+
+    if (!kms_find_output (pk, &crtc_index) || !kms_find_plane (pk, crtc_index)) {
+        printf ("%s : %s no connected output.\n", __func__, card);
+        goto err_out;
+    }
+
+    for (i = 0; i < eKMS_PROP_END; i++) {
+        if      (i < eKMS_CRTC_MODE_ID) { obj = pk->conn_id;  type = DRM_MODE_OBJECT_CONNECTOR; }
+        else if (i < eKMS_PLANE_FB_ID)  { obj = pk->crtc_id;  type = DRM_MODE_OBJECT_CRTC;      }
+        else                            { obj = pk->plane_id; type = DRM_MODE_OBJECT_PLANE;     }
+
+        if (!(pk->prop[i] = kms_prop_id (pk->fd, obj, type, KmsPropName[i], NULL))) {
+            printf ("%s : property %s not found.\n", __func__, KmsPropName[i]);
+            goto err_out;
+        }
+    }
+
+    memset (&blob, 0, sizeof(blob));
+    blob.data   = (unsigned long)&pk->mode;
+    blob.length = sizeof(pk->mode);
+    if (ioctl (pk->fd, DRM_IOCTL_MODE_CREATEPROPBLOB, &blob))
+        goto err_out;
+    pk->mode_blob = blob.blob_id;
+
+    if (!kms_buf_create (pk, &pk->buf[0]) || !kms_buf_create (pk, &pk->buf[1]))
+        goto err_out;
+
+    if (!kms_src_open (pk, fb_dev))
+        goto err_out;
+
+    if (!kms_modeset (pk)) {
+        printf ("%s : modeset error.\n", __func__);
+        goto err_out;
+    }
+
+    printf ("%s : %s %s (%dx%d@%d) <- %s (%dx%d)\n", __func__, card, pk->mode.name,
+            pk->mode.hdisplay, pk->mode.vdisplay, pk->mode.vrefresh,
+            fb_dev, pk->src_w, pk->src_h);
+    pk->init = 1;
+    kms_present ();
+    return 1;
+
+err_out:
+    // kernel releases the dumb buffers, fbs and blob on close.
+    for (i = 0; i < 2; i++)
+        if (pk->buf[i].map)     munmap (pk->buf[i].map, pk->buf[i].size);
+    if (pk->src_fd >= 0)        close (pk->src_fd);
+    close (pk->fd);
+    memset (pk, 0, sizeof(struct kms_present));
+    pk->fd = pk->src_fd = -1;
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+// source fb -> back buffer, page flip at the vertical blank.
+// return : 1 flip done, 0 error
+//------------------------------------------------------------------------------
+int kms_present (void)
+{
+    struct kms_present *pk = &KmsPresent;
+    struct kms_buf *pb;
+    struct kms_atomic a;
+    unsigned int y, w, h;
+
+    if (!pk->init)
+        return 0;
+
+    pb = &pk->buf[!pk->front];
+    w  = (pk->src_w < pk->mode.hdisplay) ? pk->src_w : pk->mode.hdisplay;
+    h  = (pk->src_h < pk->mode.vdisplay) ? pk->src_h : pk->mode.vdisplay;
+    for (y = 0; y < h; y++)
+        memcpy (pb->map + y * pb->pitch, pk->src + y * pk->src_pitch, w * 4);
+
+    memset (&a, 0, sizeof(a));
+    kms_atomic_add (&a, pk->plane_id, pk->prop[eKMS_PLANE_FB_ID], pb->fb_id);
+    if (!kms_atomic_commit (pk, &a, DRM_MODE_ATOMIC_NONBLOCK | DRM_MODE_PAGE_FLIP_EVENT))
+        return 0;
+
+    // queued flip : back buffer is the next scanout buffer.
+    pk->front = !pk->front;
+    if (!kms_wait_flip (pk)) {
+        printf ("%s : flip timeout.\n", __func__);
+        return 0;
+    }
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,29 @@
+//------------------------------------------------------------------------------
+/**
+ * @file kms_present.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief DRM/KMS(atomic) display output for ODROID-JIG.
+ * @version 0.2
+ * @date 2024-07-15
+ *
+ * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __KMS_PRESENT_H__
+#define __KMS_PRESENT_H__
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+extern int kms_present_init (const char *card, const char *fb_dev);
+extern int kms_present      (void);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __KMS_PRESENT_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
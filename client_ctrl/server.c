@@ -0,0 +1,544 @@
+//------------------------------------------------------------------------------
+/**
+ * @file server.c
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief NLP Server control helper for ODROID-JIG.
+ * @version 0.2
+ * @date 2024-07-15
+ *
+ * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <time.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/types.h>
+
+//------------------------------------------------------------------------------
+#include "../nlp_server_ctrl/nlp_server_ctrl.h"
+#include "server.h"
+
+//------------------------------------------------------------------------------
+//
+// Configuration
+//
+//------------------------------------------------------------------------------
+#define IP_STR_LENGTH       20
+
+// probe timeout (ms) : cached ip, subnet scan
+#define PROBE_CACHE_TIMEOUT 50
+#define PROBE_SCAN_TIMEOUT  300
+
+// subnet scan range (x.x.x.1 ~ x.x.x.254)
+#define PROBE_HOST_START    1
+#define PROBE_HOST_END      254
+#define PROBE_HOST_CNT      (PROBE_HOST_END - PROBE_HOST_START + 1)
+
+// sender queue (power of 2), retry count and delay(ms) of a message send
+#define SENDER_QUEUE_SIZE   64
+#define SENDER_QUEUE_MASK   (SENDER_QUEUE_SIZE -1)
+#define SENDER_RETRY        3
+#define SENDER_RETRY_DELAY  200
+
+// same result line within the window is sent once (ms).
+// nlp messages are never coalesced (MAC resend on the long press is intended)
+#define SENDER_COALESCE_MS  1000
+
+// result stream connect / send timeout (ms)
+#define RESULT_CONNECT_TIMEOUT  1000
+#define RESULT_SEND_TIMEOUT     1000
+
+struct server_msg {
+    int type, channel;
+    char msg[SERVER_MSG_SIZE +1];
+};
+
+// bounded mpsc ring. seq == pos : empty slot, seq == pos +1 : filled slot
+struct sender_slot {
+    unsigned int seq;
+    struct server_msg m;
+};
+
+struct server_sender {
+    // server address, written by server_sender_init() on re-init.
+    // addr_lock : ip, result_addr (the sender thread copies them)
+    pthread_mutex_t addr_lock;
+    char ip[IP_STR_LENGTH];
+    struct sockaddr_in result_addr;
+
+    int  init, busy;
+    // stream socket (tcp), reconnect : server ip changed
+    int  fd, reconnect;
+    unsigned int head, tail;
+    sem_t sem;
+    pthread_t thread;
+
+    struct server_msg last;
+    unsigned long last_ms;
+
+    struct sender_slot ring[SENDER_QUEUE_SIZE];
+};
+
+static struct server_sender Sender;
+
+//------------------------------------------------------------------------------
+static unsigned long server_ms (void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+//------------------------------------------------------------------------------
+// nlp_server_ctrl listen port : nlp_server_ctrl.h (NLP_SERVER_PORT) or the
+// "port=" line of NLP_SERVER_CONF. return 0 if unknown (probe skipped).
+//------------------------------------------------------------------------------
+static int probe_port (void)
+{
+    static int port = -1;
+    FILE *fp;
+    char rdata[32];
+
+    if (port >= 0)
+        return port;
+
+    port = 0;
+#if defined(NLP_SERVER_PORT)
+    port = NLP_SERVER_PORT;
+#endif
+    if ((fp = fopen (NLP_SERVER_CONF, "r")) != NULL) {
+        while (fgets (rdata, sizeof(rdata), fp) != NULL) {
+            if (!strncmp (rdata, "port=", 5))
+                port = atoi (&rdata[5]);
+        }
+        fclose (fp);
+    }
+    if (!port)
+        printf ("%s : nlp server port unknown (%s), probe skipped.\n", __func__, NLP_SERVER_CONF);
+    return port;
+}
+
+//------------------------------------------------------------------------------
+static int probe_open (in_addr_t addr)
+{
+    struct sockaddr_in sa;
+    int fd;
+
+    if ((fd = socket (AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0)) < 0)
+        return -1;
+
+    memset (&sa, 0, sizeof(sa));
+    sa.sin_family      = AF_INET;
+    sa.sin_port        = htons (probe_port ());
+    sa.sin_addr.s_addr = addr;
+
+    if (connect (fd, (struct sockaddr *)&sa, sizeof(sa)) && (errno != EINPROGRESS)) {
+        close (fd);
+        return -1;
+    }
+    return fd;
+}
+
+//------------------------------------------------------------------------------
+static int probe_connected (int fd)
+{
+    int err = 0;
+    socklen_t len = sizeof(err);
+
+    if (getsockopt (fd, SOL_SOCKET, SO_ERROR, &err, &len))
+        return 0;
+    return err ? 0 : 1;
+}
+
+//------------------------------------------------------------------------------
+// non-blocking connect to all addrs at once, the first accepted addr is returned.
+// return : index of addrs, -1 = not found
+//------------------------------------------------------------------------------
+static int probe_hosts (in_addr_t *addrs, int cnt, int timeout_ms)
+{
+    struct pollfd *pfd;
+    unsigned long deadline = server_ms () + timeout_ms;
+    int i, n, found = -1, remain = 0, left;
+
+    if (!probe_port ())
+        return -1;
+
+    if ((pfd = calloc (cnt, sizeof(struct pollfd))) == NULL)
+        return -1;
+
+    for (i = 0; i < cnt; i++) {
+        pfd[i].fd     = addrs[i] ? probe_open (addrs[i]) : -1;
+        pfd[i].events = POLLOUT;
+        if (pfd[i].fd >= 0) remain++;
+    }
+
+    // timeout_ms is the total scan time, not per wakeup.
+    while (remain && (found < 0)) {
+        if ((left = (int)(deadline - server_ms ())) <= 0)
+            break;
+        if ((n = poll (pfd, cnt, left)) <= 0)
+            break;
+        for (i = 0; i < cnt; i++) {
+            if ((pfd[i].fd < 0) || !pfd[i].revents)
+                continue;
+            if (probe_connected (pfd[i].fd)) {
+                found = i;  break;
+            }
+            // refused, unreachable : drop from the poll list
+            close (pfd[i].fd);  pfd[i].fd = -1;  remain--;
+        }
+    }
+
+    for (i = 0; i < cnt; i++)
+        if (pfd[i].fd >= 0)     close (pfd[i].fd);
+
+    free (pfd);
+    return found;
+}
+
+//------------------------------------------------------------------------------
+static int cache_read (char *ip)
+{
+    FILE *fp;
+    char rdata[IP_STR_LENGTH];
+
+    memset (rdata, 0, sizeof(rdata));
+    if ((fp = fopen (NLP_SERVER_CACHE, "r")) != NULL) {
+        if (fgets (rdata, sizeof(rdata), fp) != NULL) {
+            rdata[strcspn (rdata, "\r\n ")] = 0;
+            strncpy (ip, rdata, IP_STR_LENGTH -1);
+        }
+        fclose (fp);
+    }
+    return strlen (ip) ? 1 : 0;
+}
+
+//------------------------------------------------------------------------------
+static int cache_write (const char *ip)
+{
+    FILE *fp;
+    char cached[IP_STR_LENGTH];
+
+    memset (cached, 0, sizeof(cached));
+    if (cache_read (cached) && !strcmp (cached, ip))
+        return 1;
+
+    if ((fp = fopen (NLP_SERVER_CACHE, "w")) != NULL) {
+        fprintf (fp, "%s\n", ip);
+        fclose  (fp);
+        sync ();
+        return 1;
+    }
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+// 1. cached server ip, 2. parallel probe of the board subnet(/24),
+// 3. nlp_server_find() (nmap scan)
+//------------------------------------------------------------------------------
+int server_find (const char *my_ip, char *server_ip)
+{
+    char ip[IP_STR_LENGTH];
+    in_addr_t addrs[PROBE_HOST_CNT], my_addr, base;
+    struct in_addr in;
+    int i;
+
+    memset (ip, 0, sizeof(ip));
+    if (cache_read (ip)) {
+        addrs[0] = inet_addr (ip);
+        if ((addrs[0] != INADDR_NONE) && (probe_hosts (addrs, 1, PROBE_CACHE_TIMEOUT) == 0))
+            goto found;
+    }
+
+    if ((my_addr = inet_addr (my_ip)) != INADDR_NONE) {
+        base = ntohl (my_addr) & 0xFFFFFF00;
+        for (i = 0; i < PROBE_HOST_CNT; i++) {
+            addrs[i] = htonl (base | (PROBE_HOST_START + i));
+            if (addrs[i] == my_addr)    addrs[i] = 0;
+        }
+        if ((i = probe_hosts (addrs, PROBE_HOST_CNT, PROBE_SCAN_TIMEOUT)) >= 0) {
+            in.s_addr = addrs[i];
+            memset  (ip, 0, sizeof(ip));
+            strncpy (ip, inet_ntoa (in), sizeof(ip) -1);
+            goto found;
+        }
+    }
+
+    memset (ip, 0, sizeof(ip));
+    if (!nlp_server_find (ip))
+        return 0;
+found:
+    printf ("%s : nlp server ip = %s\n", __func__, ip);
+    strncpy (server_ip, ip, IP_STR_LENGTH -1);
+    cache_write (ip);
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+// single consumer (sender thread)
+//------------------------------------------------------------------------------
+static int sender_dequeue (struct server_sender *ps, struct server_msg *m)
+{
+    struct sender_slot *slot = &ps->ring[ps->tail & SENDER_QUEUE_MASK];
+    unsigned int seq = __atomic_load_n (&slot->seq, __ATOMIC_ACQUIRE);
+
+    if ((int)(seq - (ps->tail + 1)) < 0)
+        return 0;
+
+    memcpy (m, &slot->m, sizeof(struct server_msg));
+    __atomic_store_n (&slot->seq, ps->tail + SENDER_QUEUE_SIZE, __ATOMIC_RELEASE);
+    __atomic_store_n (&ps->tail, ps->tail + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+static int result_connect (struct sockaddr_in *sa)
+{
+    struct pollfd pfd;
+    struct timeval tv;
+    int fd, flags;
+
+    if ((fd = socket (AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0)) < 0)
+        return -1;
+
+    if (connect (fd, (struct sockaddr *)sa, sizeof(*sa)) && (errno != EINPROGRESS))
+        goto err_out;
+
+    pfd.fd = fd;    pfd.events = POLLOUT;   pfd.revents = 0;
+    if ((poll (&pfd, 1, RESULT_CONNECT_TIMEOUT) <= 0) || !probe_connected (fd))
+        goto err_out;
+
+    // blocking writes from here (one line per send). A stalled server
+    // fails the send after the timeout instead of blocking the sender thread.
+    tv.tv_sec  = RESULT_SEND_TIMEOUT / 1000;
+    tv.tv_usec = (RESULT_SEND_TIMEOUT % 1000) * 1000;
+    if (setsockopt (fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv)))
+        goto err_out;
+
+    flags = fcntl (fd, F_GETFL);
+    fcntl (fd, F_SETFL, flags & ~O_NONBLOCK);
+    return fd;
+err_out:
+    close (fd);
+    return -1;
+}
+
+//------------------------------------------------------------------------------
+static void sender_addr (struct server_sender *ps, char *ip, struct sockaddr_in *sa)
+{
+    pthread_mutex_lock   (&ps->addr_lock);
+    if (ip) memcpy (ip, ps->ip, IP_STR_LENGTH);
+    if (sa) memcpy (sa, &ps->result_addr, sizeof(struct sockaddr_in));
+    pthread_mutex_unlock (&ps->addr_lock);
+}
+
+//------------------------------------------------------------------------------
+// one line per send over the kept tcp connection. The connection is opened
+// on the first send and after an error only. return 0 on error.
+//------------------------------------------------------------------------------
+static int sender_stream (struct server_sender *ps, const char *line)
+{
+    struct sockaddr_in sa;
+    int len = strlen (line);
+
+    if (__atomic_exchange_n (&ps->reconnect, 0, __ATOMIC_ACQ_REL) && (ps->fd >= 0)) {
+        close (ps->fd);     ps->fd = -1;
+    }
+    if (ps->fd < 0) {
+        sender_addr (ps, NULL, &sa);
+        if ((ps->fd = result_connect (&sa)) < 0)
+            return 0;
+    }
+    if (send (ps->fd, line, len, MSG_NOSIGNAL) != len) {
+        close (ps->fd);     ps->fd = -1;
+        return 0;
+    }
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+// nlp message line : "N,<channel>,<type>,<msg>\n" on the stream connection.
+// A server without the stream port gets the message through nlp_server_write().
+//------------------------------------------------------------------------------
+static int sender_nlp (struct server_sender *ps, struct server_msg *m)
+{
+    char line[SERVER_MSG_SIZE + 32], ip[IP_STR_LENGTH];
+
+    snprintf (line, sizeof(line), "N,%d,%d,%s\n", m->channel, m->type, m->msg);
+    if (sender_stream (ps, line))
+        return 1;
+
+    sender_addr (ps, ip, NULL);
+    return nlp_server_write (ip, m->type, m->msg, m->channel) ? 1 : 0;
+}
+
+//------------------------------------------------------------------------------
+static void *sender_thread (void *arg)
+{
+    struct server_sender *ps = (struct server_sender *)arg;
+    struct server_msg m;
+    int retry;
+
+    while (1) {
+        sem_wait (&ps->sem);
+        __atomic_store_n (&ps->busy, 1, __ATOMIC_RELEASE);
+
+        // drain in order, head of line retry keeps the message order.
+        while (sender_dequeue (ps, &m)) {
+            // result lines are idempotent, nlp messages are sent as queued.
+            if (m.type == SERVER_MSG_TYPE_RESULT) {
+                if (!memcmp (&m, &ps->last, sizeof(m)) &&
+                    ((server_ms () - ps->last_ms) < SENDER_COALESCE_MS))
+                    continue;
+                memcpy (&ps->last, &m, sizeof(m));
+                ps->last_ms = server_ms ();
+            }
+
+            for (retry = 0; retry < SENDER_RETRY; retry++) {
+                if (m.type == SERVER_MSG_TYPE_RESULT) {
+                    if (sender_stream (ps, m.msg))
+                        break;
+                } else {
+                    if (sender_nlp (ps, &m))
+                        break;
+                }
+                usleep (SENDER_RETRY_DELAY * 1000);
+            }
+            if (retry == SENDER_RETRY)
+                printf ("%s : send error! (type = %d, msg = %s)\n", __func__, m.type, m.msg);
+        }
+        __atomic_store_n (&ps->busy, 0, __ATOMIC_RELEASE);
+    }
+    return arg;
+}
+
+//------------------------------------------------------------------------------
+int server_sender_init (const char *server_ip)
+{
+    struct server_sender *ps = &Sender;
+    int i;
+
+    if (ps->init) {
+        pthread_mutex_lock   (&ps->addr_lock);
+        memset  (ps->ip, 0, IP_STR_LENGTH);
+        strncpy (ps->ip, server_ip, IP_STR_LENGTH -1);
+        ps->result_addr.sin_addr.s_addr = inet_addr (server_ip);
+        pthread_mutex_unlock (&ps->addr_lock);
+        __atomic_store_n (&ps->reconnect, 1, __ATOMIC_RELEASE);
+        return 1;
+    }
+
+    memset (ps, 0, sizeof(struct server_sender));
+    pthread_mutex_init (&ps->addr_lock, NULL);
+    strncpy (ps->ip, server_ip, IP_STR_LENGTH -1);
+
+    ps->fd = -1;
+    ps->result_addr.sin_family      = AF_INET;
+    ps->result_addr.sin_port        = htons (NLP_RESULT_PORT);
+    ps->result_addr.sin_addr.s_addr = inet_addr (server_ip);
+
+    for (i = 0; i < SENDER_QUEUE_SIZE; i++)
+        ps->ring[i].seq = i;
+
+    sem_init (&ps->sem, 0, 0);
+    if (pthread_create (&ps->thread, NULL, sender_thread, ps))
+        return 0;
+
+    ps->init = 1;
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+// multi producer, never blocks. return 0 if the queue is full.
+//------------------------------------------------------------------------------
+int server_send (int type, const char *msg, int channel)
+{
+    struct server_sender *ps = &Sender;
+    struct sender_slot *slot;
+    unsigned int pos, seq;
+    int diff;
+
+    if (!ps->init)
+        return 0;
+
+    pos = __atomic_load_n (&ps->head, __ATOMIC_RELAXED);
+    while (1) {
+        slot = &ps->ring[pos & SENDER_QUEUE_MASK];
+        seq  = __atomic_load_n (&slot->seq, __ATOMIC_ACQUIRE);
+        diff = (int)(seq - pos);
+
+        if (!diff) {
+            if (__atomic_compare_exchange_n (&ps->head, &pos, pos + 1, 0,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        } else if (diff < 0) {
+            printf ("%s : queue full! (msg = %s)\n", __func__, msg);
+            return 0;
+        } else {
+            pos = __atomic_load_n (&ps->head, __ATOMIC_RELAXED);
+        }
+    }
+
+    memset  (&slot->m, 0, sizeof(struct server_msg));
+    slot->m.type    = type;
+    slot->m.channel = channel;
+    strncpy (slot->m.msg, msg, SERVER_MSG_SIZE);
+    __atomic_store_n (&slot->seq, pos + 1, __ATOMIC_RELEASE);
+
+    sem_post (&ps->sem);
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+// result line : "R,<channel>,<item>,<P|F>,<value>\n"
+//------------------------------------------------------------------------------
+int server_result (int channel, const char *item, int result, const char *value)
+{
+    char msg[SERVER_MSG_SIZE +1];
+
+    memset   (msg, 0, sizeof(msg));
+    snprintf (msg, sizeof(msg), "R,%d,%s,%c,%s\n",
+                channel, item, result ? 'P' : 'F', value ? value : "");
+
+    return server_send (SERVER_MSG_TYPE_RESULT, msg, channel);
+}
+
+//------------------------------------------------------------------------------
+// wait until all queued messages are sent. return 0 on timeout.
+//------------------------------------------------------------------------------
+int server_sync (int timeout_ms)
+{
+    struct server_sender *ps = &Sender;
+    unsigned long start = server_ms ();
+
+    if (!ps->init)
+        return 0;
+
+    while ((__atomic_load_n (&ps->tail, __ATOMIC_ACQUIRE) !=
+            __atomic_load_n (&ps->head, __ATOMIC_ACQUIRE)) ||
+            __atomic_load_n (&ps->busy, __ATOMIC_ACQUIRE)) {
+        if ((int)(server_ms () - start) > timeout_ms)
+            return 0;
+        usleep (10 * 1000);
+    }
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
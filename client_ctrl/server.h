@@ -0,0 +1,57 @@
+//------------------------------------------------------------------------------
+/**
+ * @file server.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief NLP Server control helper for ODROID-JIG.
+ * @version 0.2
+ * @date 2024-07-15
+ *
+ * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __SERVER_H__
+#define __SERVER_H__
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+// nlp_server_ctrl listen port (probe target) : NLP_SERVER_PORT of
+// nlp_server_ctrl.h, else "port=<n>" of this file. (unknown : nmap scan only)
+#define NLP_SERVER_CONF     "/boot/nlp_server.conf"
+
+// last good server ip (/boot is not covered by the overlayroot)
+#define NLP_SERVER_CACHE    "/boot/nlp_server.cache"
+
+// item result / message stream (tcp port of the nlp server pc, one connection per jig)
+// line : "R,<channel>,<item>,<P|F>,<value>\n"
+//  channel : NLP_SERVER_CHANNEL_LEFT/RIGHT, item : m2_item name ("iperf"),
+//  value   : raw value of the item (MB/s, mV, Mbits/sec ...), may be empty.
+// line : "N,<channel>,<type>,<msg>\n"
+//  type    : NLP_SERVER_MSG_TYPE_xxx, msg : same as nlp_server_write().
+//  (server without this port : nlp messages go through nlp_server_write())
+// The connection is kept, a failed send reconnects and is retried.
+#define NLP_RESULT_PORT     8889
+
+// max message length of the sender queue
+#define SERVER_MSG_SIZE     64
+
+// internal message type (result stream), not a nlp_server_ctrl type.
+#define SERVER_MSG_TYPE_RESULT  -1
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+extern int server_find         (const char *my_ip, char *server_ip);
+extern int server_sender_init  (const char *server_ip);
+extern int server_send         (int type, const char *msg, int channel);
+extern int server_result       (int channel, const char *item, int result, const char *value);
+extern int server_sync         (int timeout_ms);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __SERVER_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,163 @@
+//------------------------------------------------------------------------------
+/**
+ * @file ui_bench.c
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief lib_fbui rendering benchmark for ODROID-JIG.
+ * @version 0.2
+ * @date 2024-07-15
+ *
+ * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+//------------------------------------------------------------------------------
+#include "ui_ctrl.h"
+#include "ui_bench.h"
+
+//------------------------------------------------------------------------------
+//
+// Configuration
+//
+//------------------------------------------------------------------------------
+// m2.cfg status box, alive box
+#define BENCH_ALIVE_ID      0
+#define BENCH_STATUS_ID     47
+
+// config 'B' line group id of the value(result) box
+#define BENCH_VALUE_GROUP   1
+
+#define DIRTY_WORDS         (UI_ID_MAX / 32)
+
+struct bench_layout {
+    // item id list (cfg order), item id list of the value boxes
+    int id[UI_ID_MAX], id_cnt;
+    int value_id[UI_ID_MAX], value_cnt;
+    // framebuffer bytes of the item box
+    unsigned long bytes[UI_ID_MAX], total;
+};
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+static unsigned long bench_us (void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+//------------------------------------------------------------------------------
+// B(cmd), ID(id), x%, y%, w%, h%, lw, scale, align, GroupID, str
+//------------------------------------------------------------------------------
+static int bench_layout_read (const char *cfg, struct bench_layout *pl)
+{
+    FILE *fp;
+    char line[256];
+    int id, x, y, w, h, group, fb_w, fb_h, bpp;
+
+    if (!ui_ctrl_fb_info (&fb_w, &fb_h, &bpp))
+        return 0;
+
+    if ((fp = fopen (cfg, "r")) == NULL)
+        return 0;
+
+    memset (pl, 0, sizeof(struct bench_layout));
+    while (fgets (line, sizeof(line), fp) != NULL) {
+        if (sscanf (line, "B,%d,%d,%d,%d,%d,%*d,%*d,%*d,%d",
+                    &id, &x, &y, &w, &h, &group) != 6)
+            continue;
+        if ((id < 0) || (id >= UI_ID_MAX))
+            continue;
+
+        pl->bytes[id] = (unsigned long)(w * fb_w / 100) * (h * fb_h / 100) * (bpp / 8);
+        pl->total    += pl->bytes[id];
+        pl->id[pl->id_cnt++] = id;
+
+        if (group == BENCH_VALUE_GROUP)
+            pl->value_id[pl->value_cnt++] = id;
+    }
+    fclose (fp);
+    return pl->value_cnt;
+}
+
+//------------------------------------------------------------------------------
+static unsigned long bench_redrawn_bytes (struct bench_layout *pl)
+{
+    unsigned int map[DIRTY_WORDS], word;
+    unsigned long bytes = 0;
+    int i;
+
+    ui_ctrl_redrawn (map);
+    for (i = 0; i < DIRTY_WORDS; i++) {
+        for (word = map[i]; word; word &= word - 1)
+            bytes += pl->bytes[i * 32 + __builtin_ctz (word)];
+    }
+    return bytes;
+}
+
+//------------------------------------------------------------------------------
+// 1. full layout redraw (ui_update (fb, ui, -1))
+// 2. replay of the jig updates (alive box, status box, one result box / frame)
+//------------------------------------------------------------------------------
+int ui_bench (fb_info_t *fb, ui_grp_t *ui, const char *cfg, int frames)
+{
+    struct bench_layout *pl;
+    unsigned long start, full_us, replay_us, replay_bytes = 0;
+    unsigned int skip, draw;
+    char str[UI_STR_MAX +1];
+    int f, id;
+
+    if ((pl = calloc (1, sizeof(struct bench_layout))) == NULL)
+        return 0;
+
+    if (!bench_layout_read (cfg, pl) || (frames <= 0)) {
+        printf ("%s : layout(%s) read error.\n", __func__, cfg);
+        free (pl);
+        return 0;
+    }
+
+    start = bench_us ();
+    for (f = 0; f < frames; f++)
+        ui_update (fb, ui, -1);
+    full_us = bench_us () - start;
+
+    start = bench_us ();
+    for (f = 0; f < frames; f++) {
+        id = pl->value_id[f % pl->value_cnt];
+
+        ui_ctrl_ritem (fb, ui, BENCH_ALIVE_ID, (f & 1) ? COLOR_GREEN : ui->bc.uint, -1);
+        memset  (str, 0, sizeof(str));  sprintf (str, "RUNNING %d", frames - f);
+        ui_ctrl_sitem (fb, ui, BENCH_STATUS_ID, -1, -1, str);
+
+        memset  (str, 0, sizeof(str));  sprintf (str, "%d MB/s", f);
+        ui_ctrl_ritem (fb, ui, id, (f & 1) ? COLOR_GREEN : COLOR_YELLOW, -1);
+        ui_ctrl_sitem (fb, ui, id, -1, -1, str);
+
+        ui_ctrl_flush (fb, ui);
+        replay_bytes += bench_redrawn_bytes (pl);
+    }
+    replay_us = bench_us () - start;
+    ui_ctrl_stats (&skip, &draw);
+
+    printf ("%s : frames = %d, items = %d\n", __func__, frames, pl->value_cnt);
+    printf ("  full redraw  : %6lu us/frame, %4lu fps, %8lu bytes/update\n",
+            full_us / frames, full_us ? (frames * 1000000UL) / full_us : 0, pl->total);
+    printf ("  dirty replay : %6lu us/frame, %4lu fps, %8lu bytes/update (skip %u, drawn %u)\n",
+            replay_us / frames, replay_us ? (frames * 1000000UL) / replay_us : 0,
+            replay_bytes / frames, skip, draw);
+
+    free (pl);
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
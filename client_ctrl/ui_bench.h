@@ -0,0 +1,32 @@
+//------------------------------------------------------------------------------
+/**
+ * @file ui_bench.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief lib_fbui rendering benchmark for ODROID-JIG.
+ * @version 0.2
+ * @date 2024-07-15
+ *
+ * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __UI_BENCH_H__
+#define __UI_BENCH_H__
+
+//------------------------------------------------------------------------------
+#include "../lib_fbui/lib_fb.h"
+#include "../lib_fbui/lib_ui.h"
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+extern int ui_bench (fb_info_t *fb, ui_grp_t *ui, const char *cfg, int frames);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __UI_BENCH_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,570 @@
+//------------------------------------------------------------------------------
+/**
+ * @file ui_ctrl.c
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief lib_fbui control helper for ODROID-JIG.
+ * @version 0.2
+ * @date 2024-07-15
+ *
+ * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <linux/fb.h>
+
+//------------------------------------------------------------------------------
+#include "ui_ctrl.h"
+
+//------------------------------------------------------------------------------
+//
+// Deferred item update.
+// ui_ctrl_ritem/sitem post a small command to the lock-free(mpsc) queue and
+// return, check threads never wait for drawing.
+// The render thread(ui_ctrl_start) is the only lib_fbui caller. It collects
+// the commands of one frame, keeps only the latest request of the item and
+// redraws the changed items in one pass, right after the vertical blank.
+// This is vsync pacing (one redraw per frame, started in the blanking), not
+// a composed flip : lib_fbui draws straight into the scanout buffer, a redraw
+// longer than the blanking interval can still tear. (tear-free : -k, the
+// vfb frame is shown by a kms page flip)
+//
+// The sparse cfg item ids (0 ~ 199) are mapped to dense slots at init,
+// pending/drawn/dirty tables are indexed by the slot. (O(1), no id search)
+// ids not in the layout are dropped before queueing.
+// Only the wrapper tables are indexed : ui_set_ritem/sitem and ui_update
+// still search the id inside lib_fbui for every redrawn item.
+//
+//------------------------------------------------------------------------------
+#define DIRTY_WORDS     (UI_ID_MAX / 32)
+
+#define PENDING_RITEM   0x01
+#define PENDING_SITEM   0x02
+
+#define UI_CMD_QUEUE_SIZE   256
+#define UI_CMD_QUEUE_MASK   (UI_CMD_QUEUE_SIZE -1)
+
+// queue full : producer waits for the next frame drain (1ms x retry)
+#define UI_CMD_FULL_RETRY   50
+
+// frame period of the fb without vsync (vfb)
+#define UI_FRAME_MS         16
+
+struct ui_cmd {
+    // PENDING_RITEM : a = bc, b = lc, PENDING_SITEM : a = fc, b = bc, str
+    int type, slot, a, b;
+    char str[UI_STR_MAX +1];
+};
+
+// bounded mpsc ring. seq == pos : empty slot, seq == pos +1 : filled slot
+struct ui_cmd_slot {
+    unsigned int seq;
+    struct ui_cmd c;
+};
+
+struct ui_pending {
+    int flags;
+    // ritem : box, line color
+    int bc, lc;
+    // sitem : font, background color, string
+    int s_fc, s_bc;
+    char str[UI_STR_MAX +1];
+};
+
+//------------------------------------------------------------------------------
+// Unchanged item skip.
+// The last drawn state of the item. A request equal to the drawn state is
+// skipped, lib_fbui renders only the changed text/box (no glyph cache).
+//------------------------------------------------------------------------------
+struct ui_drawn {
+    int valid;
+    int bc, lc;
+    int s_fc, s_bc;
+    char str[UI_STR_MAX +1];
+};
+
+struct ui_ctrl {
+    // fb device fd (vsync wait, snapshot), vsync : 0 = not supported
+    int fd, vsync;
+
+    // id -> slot +1 (0 : not in layout), slot -> id
+    short slot[UI_ID_MAX], ids[UI_ID_MAX];
+    int slot_cnt;
+
+    // command queue, render thread
+    unsigned int head, tail, drop;
+    int run, busy;
+    sem_t sem;
+    pthread_t thread;
+    fb_info_t *fb;
+    ui_grp_t  *ui;
+    // frame output after redraw (kms page flip), NULL : fb scanout
+    int (*present)(void);
+    struct ui_cmd_slot ring[UI_CMD_QUEUE_SIZE];
+
+    // latest request of the item (render thread only)
+    unsigned int dirty[DIRTY_WORDS];
+    struct ui_pending pending[UI_ID_MAX];
+
+    // last drawn state, skipped/drawn count (render thread only)
+    struct ui_drawn drawn[UI_ID_MAX];
+    unsigned int skip, draw;
+
+    // redrawn items of the last flush
+    unsigned int redrawn[DIRTY_WORDS];
+};
+
+static struct ui_ctrl UiCtrl = { .fd = -1, };
+
+//------------------------------------------------------------------------------
+// B(cmd), ID(id), ... : item id of the layout, slot is the cfg order.
+// cfg read error : all ids are used. (slot = id)
+//------------------------------------------------------------------------------
+static int ui_ctrl_index (struct ui_ctrl *pc, const char *cfg)
+{
+    FILE *fp;
+    char line[256];
+    int id;
+
+    memset (pc->slot, 0, sizeof(pc->slot));
+    pc->slot_cnt = 0;
+
+    if ((fp = fopen (cfg, "r")) != NULL) {
+        while (fgets (line, sizeof(line), fp) != NULL) {
+            if ((sscanf (line, "B,%d,", &id) != 1) || (id < 0) || (id >= UI_ID_MAX))
+                continue;
+            if (pc->slot[id])
+                continue;
+            pc->ids[pc->slot_cnt] = id;
+            pc->slot[id] = ++pc->slot_cnt;
+        }
+        fclose (fp);
+    }
+    if (!pc->slot_cnt) {
+        for (id = 0; id < UI_ID_MAX; id++) {
+            pc->ids[id]  = id;
+            pc->slot[id] = id + 1;
+        }
+        pc->slot_cnt = UI_ID_MAX;
+    }
+    return pc->slot_cnt;
+}
+
+//------------------------------------------------------------------------------
+// item slot of the id. (-1 : not in layout)
+//------------------------------------------------------------------------------
+static int ui_ctrl_slot (int id)
+{
+    if ((id < 0) || (id >= UI_ID_MAX))
+        return -1;
+    return UiCtrl.slot[id] - 1;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+int ui_ctrl_init (const char *fb_dev, const char *cfg)
+{
+    struct ui_ctrl *pc = &UiCtrl;
+    unsigned int screen = 0;
+    int i;
+
+    for (i = 0; i < UI_CMD_QUEUE_SIZE; i++)
+        pc->ring[i].seq = i;
+    sem_init (&pc->sem, 0, 0);
+
+    printf ("%s : %d items indexed.\n", __func__, ui_ctrl_index (pc, cfg));
+
+    if ((pc->fd = open (fb_dev, O_RDWR)) < 0)
+        return 0;
+
+    // vfb(memory backed fb) has no vsync.
+    if (!(pc->vsync = ioctl (pc->fd, FBIO_WAITFORVSYNC, &screen) ? 0 : 1))
+        printf ("%s : %s vsync wait not supported.\n", __func__, fb_dev);
+
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+int ui_ctrl_fb_info (int *w, int *h, int *bpp)
+{
+    struct fb_var_screeninfo var;
+
+    if ((UiCtrl.fd < 0) || ioctl (UiCtrl.fd, FBIOGET_VSCREENINFO, &var))
+        return 0;
+
+    if (w)      *w   = var.xres;
+    if (h)      *h   = var.yres;
+    if (bpp)    *bpp = var.bits_per_pixel;
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+static unsigned char fb_color (unsigned int pixel, struct fb_bitfield *bf)
+{
+    unsigned int v = (pixel >> bf->offset) & ((1u << bf->length) -1);
+
+    return (bf->length >= 8) ? (v >> (bf->length - 8)) : (v << (8 - bf->length));
+}
+
+//------------------------------------------------------------------------------
+// visible screen dump (binary ppm, P6). 16/24/32 bpp.
+//------------------------------------------------------------------------------
+int ui_ctrl_snapshot (const char *ppm)
+{
+    struct fb_var_screeninfo var;
+    struct fb_fix_screeninfo fix;
+    unsigned char *base, *line, rgb[3];
+    unsigned int x, y, pixel, bytes;
+    FILE *fp;
+
+    if ((UiCtrl.fd < 0) ||
+        ioctl (UiCtrl.fd, FBIOGET_VSCREENINFO, &var) ||
+        ioctl (UiCtrl.fd, FBIOGET_FSCREENINFO, &fix))
+        return 0;
+
+    bytes = var.bits_per_pixel / 8;
+    if ((bytes < 2) || (bytes > 4))
+        return 0;
+
+    base = mmap (NULL, fix.smem_len, PROT_READ, MAP_SHARED, UiCtrl.fd, 0);
+    if (base == MAP_FAILED)
+        return 0;
+
+    if ((fp = fopen (ppm, "wb")) == NULL) {
+        munmap (base, fix.smem_len);
+        return 0;
+    }
+
+    fprintf (fp, "P6\n%u %u\n255\n", var.xres, var.yres);
+    for (y = 0; y < var.yres; y++) {
+        line = base + (y + var.yoffset) * fix.line_length + var.xoffset * bytes;
+        for (x = 0; x < var.xres; x++, line += bytes) {
+            pixel = 0;
+            memcpy (&pixel, line, bytes);
+            rgb[0] = fb_color (pixel, &var.red);
+            rgb[1] = fb_color (pixel, &var.green);
+            rgb[2] = fb_color (pixel, &var.blue);
+            fwrite (rgb, 1, sizeof(rgb), fp);
+        }
+    }
+    fclose (fp);
+    munmap (base, fix.smem_len);
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+// multi producer, never blocks on drawing. return 0 if dropped.
+//------------------------------------------------------------------------------
+static int ui_cmd_push (struct ui_ctrl *pc, struct ui_cmd *c)
+{
+    struct ui_cmd_slot *slot;
+    unsigned int pos, seq;
+    int diff, retry = 0;
+
+    pos = __atomic_load_n (&pc->head, __ATOMIC_RELAXED);
+    while (1) {
+        slot = &pc->ring[pos & UI_CMD_QUEUE_MASK];
+        seq  = __atomic_load_n (&slot->seq, __ATOMIC_ACQUIRE);
+        diff = (int)(seq - pos);
+
+        if (!diff) {
+            if (__atomic_compare_exchange_n (&pc->head, &pos, pos + 1, 0,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        } else if (diff < 0) {
+            if (retry++ > UI_CMD_FULL_RETRY) {
+                __atomic_add_fetch (&pc->drop, 1, __ATOMIC_RELAXED);
+                return 0;
+            }
+            usleep (1000);
+            pos = __atomic_load_n (&pc->head, __ATOMIC_RELAXED);
+        } else {
+            pos = __atomic_load_n (&pc->head, __ATOMIC_RELAXED);
+        }
+    }
+
+    memcpy (&slot->c, c, sizeof(struct ui_cmd));
+    __atomic_store_n (&slot->seq, pos + 1, __ATOMIC_RELEASE);
+
+    sem_post (&pc->sem);
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+// single consumer (render thread)
+//------------------------------------------------------------------------------
+static int ui_cmd_pop (struct ui_ctrl *pc, struct ui_cmd *c)
+{
+    struct ui_cmd_slot *slot = &pc->ring[pc->tail & UI_CMD_QUEUE_MASK];
+    unsigned int seq = __atomic_load_n (&slot->seq, __ATOMIC_ACQUIRE);
+
+    if ((int)(seq - (pc->tail + 1)) < 0)
+        return 0;
+
+    memcpy (c, &slot->c, sizeof(struct ui_cmd));
+    __atomic_store_n (&slot->seq, pc->tail + UI_CMD_QUEUE_SIZE, __ATOMIC_RELEASE);
+    __atomic_store_n (&pc->tail, pc->tail + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+// queued commands -> latest request of the item. (coalesce)
+//------------------------------------------------------------------------------
+static int ui_ctrl_drain (struct ui_ctrl *pc)
+{
+    struct ui_pending *pp;
+    struct ui_cmd c;
+    int cnt = 0;
+
+    while (ui_cmd_pop (pc, &c)) {
+        pp = &pc->pending[c.slot];
+        pc->dirty[c.slot / 32] |= 1u << (c.slot % 32);
+
+        if (c.type == PENDING_RITEM) {
+            if (!(pp->flags & PENDING_RITEM))
+                pp->bc = pp->lc = -1;
+            if (c.a != -1)  pp->bc = c.a;
+            if (c.b != -1)  pp->lc = c.b;
+        } else {
+            if (!(pp->flags & PENDING_SITEM))
+                pp->s_fc = pp->s_bc = -1;
+            if (c.a != -1)  pp->s_fc = c.a;
+            if (c.b != -1)  pp->s_bc = c.b;
+            memcpy (pp->str, c.str, sizeof(pp->str));
+        }
+        pp->flags |= c.type;
+        cnt++;
+    }
+    return cnt;
+}
+
+//------------------------------------------------------------------------------
+static void ui_ctrl_cmd (int type, int id, int a, int b, const char *str)
+{
+    struct ui_cmd c;
+
+    if ((c.slot = ui_ctrl_slot (id)) < 0)
+        return;
+
+    c.type = type;  c.a = a;    c.b = b;
+    memset (c.str, 0, sizeof(c.str));
+    if (str)
+        strncpy (c.str, str, UI_STR_MAX);
+
+    if (!ui_cmd_push (&UiCtrl, &c))
+        printf ("%s : queue full! (id = %d)\n", __func__, id);
+}
+
+//------------------------------------------------------------------------------
+void ui_ctrl_ritem (fb_info_t *fb, ui_grp_t *ui, int id, int bc, int lc)
+{
+    (void)fb;   (void)ui;
+    ui_ctrl_cmd (PENDING_RITEM, id, bc, lc, NULL);
+}
+
+//------------------------------------------------------------------------------
+void ui_ctrl_sitem (fb_info_t *fb, ui_grp_t *ui, int id, int fc, int bc, const char *str)
+{
+    (void)fb;   (void)ui;
+    ui_ctrl_cmd (PENDING_SITEM, id, fc, bc, str);
+}
+
+//------------------------------------------------------------------------------
+// return : 1 if the pending request changes the drawn item.
+//------------------------------------------------------------------------------
+static int ui_ctrl_changed (struct ui_drawn *pd, struct ui_pending *pp)
+{
+    int changed = 0;
+
+    if (!pd->valid) {
+        memset (pd, 0, sizeof(struct ui_drawn));
+        pd->bc = pd->lc = pd->s_fc = pd->s_bc = -1;
+        pd->valid = changed = 1;
+    }
+    if (pp->flags & PENDING_RITEM) {
+        if ((pp->bc != -1) && (pp->bc != pd->bc)) { pd->bc = pp->bc; changed = 1; }
+        if ((pp->lc != -1) && (pp->lc != pd->lc)) { pd->lc = pp->lc; changed = 1; }
+    }
+    if (pp->flags & PENDING_SITEM) {
+        if ((pp->s_fc != -1) && (pp->s_fc != pd->s_fc)) { pd->s_fc = pp->s_fc; changed = 1; }
+        if ((pp->s_bc != -1) && (pp->s_bc != pd->s_bc)) { pd->s_bc = pp->s_bc; changed = 1; }
+        if (strncmp (pp->str, pd->str, UI_STR_MAX)) {
+            strncpy (pd->str, pp->str, UI_STR_MAX);
+            changed = 1;
+        }
+    }
+    return changed;
+}
+
+//------------------------------------------------------------------------------
+// unchanged item skip rate (%), skipped/drawn count (NULL : not used)
+//------------------------------------------------------------------------------
+int ui_ctrl_stats (unsigned int *skip, unsigned int *draw)
+{
+    struct ui_ctrl *pc = &UiCtrl;
+    unsigned int s = pc->skip, d = pc->draw;
+
+    if (skip)   *skip = s;
+    if (draw)   *draw = d;
+
+    return (s + d) ? (int)((s * 100ULL) / (s + d)) : 0;
+}
+
+//------------------------------------------------------------------------------
+// redrawn item map of the last flush (UI_ID_MAX bits)
+//------------------------------------------------------------------------------
+void ui_ctrl_redrawn (unsigned int *map)
+{
+    memcpy (map, UiCtrl.redrawn, sizeof(UiCtrl.redrawn));
+}
+
+//------------------------------------------------------------------------------
+// redraw the changed items. return : redraw item count
+//------------------------------------------------------------------------------
+static int ui_ctrl_render (struct ui_ctrl *pc, fb_info_t *fb, ui_grp_t *ui)
+{
+    unsigned int word;
+    int i, id, slot, cnt = 0, words = (pc->slot_cnt + 31) / 32;
+
+    memset (pc->redrawn, 0, sizeof(pc->redrawn));
+
+    for (i = 0; i < words; i++) {
+        for (word = pc->dirty[i]; word; word &= word - 1) {
+            struct ui_pending *pp;
+
+            slot = i * 32 + __builtin_ctz (word);
+            pp   = &pc->pending[slot];
+            id   = pc->ids[slot];
+
+            if (!ui_ctrl_changed (&pc->drawn[slot], pp)) {
+                pc->skip++; pp->flags = 0;  continue;
+            }
+            pc->draw++;
+
+            if (pp->flags & PENDING_RITEM)
+                ui_set_ritem (fb, ui, id, pp->bc, pp->lc);
+            if (pp->flags & PENDING_SITEM)
+                ui_set_sitem (fb, ui, id, pp->s_fc, pp->s_bc, pp->str);
+            ui_update (fb, ui, id);
+            pc->redrawn[id / 32] |= 1u << (id % 32);
+            pp->flags = 0;
+            cnt++;
+        }
+        pc->dirty[i] = 0;
+    }
+    return cnt;
+}
+
+//------------------------------------------------------------------------------
+// synchronous redraw (render thread not started : bench, setup).
+// return : redraw item count
+//------------------------------------------------------------------------------
+int ui_ctrl_flush (fb_info_t *fb, ui_grp_t *ui)
+{
+    struct ui_ctrl *pc = &UiCtrl;
+    unsigned int screen = 0;
+
+    // the render thread owns lib_fbui.
+    if (pc->run)
+        return 0;
+
+    ui_ctrl_drain (pc);
+    if (pc->vsync)
+        ioctl (pc->fd, FBIO_WAITFORVSYNC, &screen);
+
+    return ui_ctrl_render (pc, fb, ui);
+}
+
+//------------------------------------------------------------------------------
+static void *ui_ctrl_thread (void *arg)
+{
+    struct ui_ctrl *pc = (struct ui_ctrl *)arg;
+    unsigned int screen = 0;
+
+    while (1) {
+        sem_wait (&pc->sem);
+        __atomic_store_n (&pc->busy, 1, __ATOMIC_RELEASE);
+
+        // one frame : collect the commands until the vertical blank.
+        if (pc->vsync)
+            ioctl (pc->fd, FBIO_WAITFORVSYNC, &screen);
+        else
+            usleep (UI_FRAME_MS * 1000);
+
+        while (!sem_trywait (&pc->sem));
+        ui_ctrl_drain  (pc);
+        if (ui_ctrl_render (pc, pc->fb, pc->ui) && pc->present)
+            pc->present ();
+
+        __atomic_store_n (&pc->busy, 0, __ATOMIC_RELEASE);
+    }
+    return arg;
+}
+
+//------------------------------------------------------------------------------
+int ui_ctrl_start (fb_info_t *fb, ui_grp_t *ui)
+{
+    struct ui_ctrl *pc = &UiCtrl;
+
+    if (pc->run)
+        return 1;
+
+    pc->fb = fb;    pc->ui = ui;
+
+    // the render thread draws the changed items only, paint the whole layout
+    // (labels, boxes never changed by a command) once before it starts.
+    ui_update (fb, ui, -1);
+    if (pc->present)
+        pc->present ();
+
+    if (pthread_create (&pc->thread, NULL, ui_ctrl_thread, pc))
+        return 0;
+
+    pc->run = 1;
+    // draw the commands queued before start.
+    sem_post (&pc->sem);
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+// drawn frame output of the render thread. (set before ui_ctrl_start)
+//------------------------------------------------------------------------------
+void ui_ctrl_present (int (*present)(void))
+{
+    UiCtrl.present = present;
+}
+
+//------------------------------------------------------------------------------
+// wait until the queued commands are drawn. return 0 if timeout.
+//------------------------------------------------------------------------------
+int ui_ctrl_sync (int timeout_ms)
+{
+    struct ui_ctrl *pc = &UiCtrl;
+
+    if (!pc->run)
+        return 0;
+
+    // queued command always keeps a sem count, the render thread wakes up.
+    while ((__atomic_load_n (&pc->tail, __ATOMIC_ACQUIRE) !=
+            __atomic_load_n (&pc->head, __ATOMIC_ACQUIRE)) ||
+            __atomic_load_n (&pc->busy, __ATOMIC_ACQUIRE)) {
+        if (timeout_ms <= 0)
+            return 0;
+        usleep (10 * 1000);     timeout_ms -= 10;
+    }
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,50 @@
+//------------------------------------------------------------------------------
+/**
+ * @file ui_ctrl.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief lib_fbui control helper for ODROID-JIG.
+ * @version 0.2
+ * @date 2024-07-15
+ *
+ * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __UI_CTRL_H__
+#define __UI_CTRL_H__
+
+//------------------------------------------------------------------------------
+#include "../lib_fbui/lib_fb.h"
+#include "../lib_fbui/lib_ui.h"
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+// max ui item id of the config file (m2.cfg : 0 ~ 199)
+#define UI_ID_MAX   256
+
+// max string length of the ui item
+#define UI_STR_MAX  63
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+extern int  ui_ctrl_init     (const char *fb_dev, const char *cfg);
+extern void ui_ctrl_ritem    (fb_info_t *fb, ui_grp_t *ui, int id, int bc, int lc);
+extern void ui_ctrl_sitem    (fb_info_t *fb, ui_grp_t *ui, int id, int fc, int bc, const char *str);
+extern int  ui_ctrl_flush    (fb_info_t *fb, ui_grp_t *ui);
+extern int  ui_ctrl_start    (fb_info_t *fb, ui_grp_t *ui);
+extern int  ui_ctrl_sync     (int timeout_ms);
+extern void ui_ctrl_present  (int (*present)(void));
+extern int  ui_ctrl_stats    (unsigned int *skip, unsigned int *draw);
+extern void ui_ctrl_redrawn  (unsigned int *map);
+extern int  ui_ctrl_fb_info  (int *w, int *h, int *bpp);
+extern int  ui_ctrl_snapshot (const char *ppm);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __UI_CTRL_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,181 @@
+//------------------------------------------------------------------------------
+/**
+ * @file ui_layout.c
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Precompiled(binary) ui layout for ODROID-JIG.
+ * @version 0.2
+ * @date 2024-07-15
+ *
+ * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+//------------------------------------------------------------------------------
+#include "ui_ctrl.h"
+#include "ui_layout.h"
+
+//------------------------------------------------------------------------------
+//
+// Binary layout file.
+// The ui_grp_t image made by ui_init() (text cfg parse, percent to pixel)
+// with a header describing what it was built from. The file is mmapped
+// (MAP_PRIVATE, copy on write) and used as the ui group without parsing.
+// Any header mismatch (cfg/app changed, fb resolution changed) is stale,
+// the text cfg is parsed again and the layout file rebuilt.
+//
+// The raw image is only valid while lib_fbui's ui_grp_t holds no pointers
+// (fixed r_item/s_item arrays, colors, pixel positions and strings only).
+// The layout file records the lib_fbui revision it was built with (Makefile
+// LIB_FBUI_REV), a lib_fbui bump rebuilds it. Re-check ui_grp_t for pointer
+// members before bumping the lib_fbui submodule.
+//
+//------------------------------------------------------------------------------
+#define UI_LAYOUT_MAGIC     0x4c55324d  // 'M2UL'
+#define UI_LAYOUT_VERSION   2
+
+#ifndef LIB_FBUI_REV
+#define LIB_FBUI_REV        "unknown"
+#endif
+
+struct ui_layout_hdr {
+    unsigned int magic, version;
+    // sizeof(ui_grp_t), data offset
+    unsigned int grp_size, offset;
+    // fb resolution
+    int w, h, bpp;
+    // source text cfg, app binary
+    long cfg_size, cfg_mtime, app_mtime;
+    // lib_fbui revision (ui_grp_t layout)
+    char fbui_rev[16];
+};
+
+//------------------------------------------------------------------------------
+static int ui_layout_hdr_make (const char *cfg, struct ui_layout_hdr *hdr)
+{
+    struct stat st_cfg, st_app;
+
+    memset (hdr, 0, sizeof(struct ui_layout_hdr));
+    if (stat (cfg, &st_cfg) || stat ("/proc/self/exe", &st_app))
+        return 0;
+    if (!ui_ctrl_fb_info (&hdr->w, &hdr->h, &hdr->bpp))
+        return 0;
+
+    hdr->magic     = UI_LAYOUT_MAGIC;
+    hdr->version   = UI_LAYOUT_VERSION;
+    hdr->grp_size  = sizeof(ui_grp_t);
+    hdr->offset    = (sizeof(struct ui_layout_hdr) + 63) & ~63;
+    hdr->cfg_size  = st_cfg.st_size;
+    hdr->cfg_mtime = st_cfg.st_mtime;
+    hdr->app_mtime = st_app.st_mtime;
+    strncpy (hdr->fbui_rev, LIB_FBUI_REV, sizeof(hdr->fbui_rev) -1);
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+static int ui_layout_save (ui_grp_t *ui, const char *cfg, const char *blob)
+{
+    struct ui_layout_hdr hdr;
+    char tmp[256];
+    int fd, ret;
+
+    if (!ui_layout_hdr_make (cfg, &hdr))
+        return 0;
+
+    // write to temp file and rename, the old layout never half written.
+    snprintf (tmp, sizeof(tmp), "%s.tmp", blob);
+    if ((fd = open (tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0)
+        return 0;
+
+    ret = (pwrite (fd, &hdr, sizeof(hdr), 0) == sizeof(hdr)) &&
+          (pwrite (fd, ui, sizeof(ui_grp_t), hdr.offset) == sizeof(ui_grp_t));
+    close (fd);
+
+    if (!ret || rename (tmp, blob)) {
+        unlink (tmp);
+        return 0;
+    }
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+static ui_grp_t *ui_layout_map (const char *cfg, const char *blob)
+{
+    struct ui_layout_hdr hdr, *phdr;
+    struct stat st;
+    void *base;
+    int fd;
+
+    if (!ui_layout_hdr_make (cfg, &hdr))
+        return NULL;
+
+    if ((fd = open (blob, O_RDONLY)) < 0)
+        return NULL;
+
+    if (fstat (fd, &st) || (st.st_size != (off_t)(hdr.offset + hdr.grp_size))) {
+        close (fd);
+        return NULL;
+    }
+    base = mmap (NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close (fd);
+
+    if (base == MAP_FAILED)
+        return NULL;
+
+    phdr = (struct ui_layout_hdr *)base;
+    if (memcmp (phdr, &hdr, sizeof(hdr))) {
+        munmap (base, st.st_size);
+        return NULL;
+    }
+    return (ui_grp_t *)((char *)base + hdr.offset);
+}
+
+//------------------------------------------------------------------------------
+// text cfg -> binary layout file
+//------------------------------------------------------------------------------
+int ui_layout_build (fb_info_t *fb, const char *cfg, const char *blob)
+{
+    ui_grp_t *ui;
+
+    if ((ui = ui_init (fb, cfg)) == NULL)
+        return 0;
+
+    if (!ui_layout_save (ui, cfg, blob)) {
+        printf ("%s : %s write error.\n", __func__, blob);
+        return 0;
+    }
+    printf ("%s : %s -> %s (%d bytes)\n", __func__, cfg, blob, (int)sizeof(ui_grp_t));
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+// binary layout (mmap), fallback to the text cfg parse if stale.
+// ui_ctrl_init() must be called first. (fb resolution)
+// A mapped layout is not drawn (no ui_init), ui_ctrl_start() paints it.
+//------------------------------------------------------------------------------
+ui_grp_t *ui_layout_load (fb_info_t *fb, const char *cfg, const char *blob)
+{
+    ui_grp_t *ui;
+
+    if ((ui = ui_layout_map (cfg, blob)) != NULL)
+        return ui;
+
+    printf ("%s : %s stale or not found, parse %s\n", __func__, blob, cfg);
+    if ((ui = ui_init (fb, cfg)) != NULL)
+        ui_layout_save (ui, cfg, blob);
+
+    return ui;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,33 @@
+//------------------------------------------------------------------------------
+/**
+ * @file ui_layout.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Precompiled(binary) ui layout for ODROID-JIG.
+ * @version 0.2
+ * @date 2024-07-15
+ *
+ * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __UI_LAYOUT_H__
+#define __UI_LAYOUT_H__
+
+//------------------------------------------------------------------------------
+#include "../lib_fbui/lib_fb.h"
+#include "../lib_fbui/lib_ui.h"
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+extern ui_grp_t *ui_layout_load  (fb_info_t *fb, const char *cfg, const char *blob);
+extern int       ui_layout_build (fb_info_t *fb, const char *cfg, const char *blob);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __UI_LAYOUT_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
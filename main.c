@@ -33,6 +33,7 @@
 #include <pthread.h>
 
 #include <signal.h>
+#include <dirent.h>
 
 //------------------------------------------------------------------------------
 #include "lib_fbui/lib_fb.h"
@@ -52,6 +53,17 @@
 #include "check_device/led.h"
 #include "check_device/header.h"
 #include "check_device/audio.h"
+#include "check_device/gpio_event.h"
+#include "check_device/sw_adc.h"
+#include "check_device/sysfs.h"
+#include "check_device/adc_svc.h"
+
+#include "client_ctrl/server.h"
+#include "client_ctrl/ui_ctrl.h"
+#include "client_ctrl/ui_bench.h"
+#include "client_ctrl/ui_layout.h"
+#include "client_ctrl/fb_stream.h"
+#include "client_ctrl/kms_present.h"
 
 //------------------------------------------------------------------------------
 //
@@ -61,6 +73,8 @@
 //------------------------------------------------------------------------------
 #define DEVICE_FB   "/dev/fb0"
 #define CONFIG_UI   "m2.cfg"
+// precompiled CONFIG_UI (make layout, rebuilt if stale)
+#define CONFIG_UI_BIN   "m2.ui"
 
 #define ALIVE_DISPLAY_UI_ID     0
 #define ALIVE_DISPLAY_INTERVAL  1000
@@ -71,6 +85,11 @@
 
 #define IP_ADDR_SIZE    20
 
+#define SERVER_SYNC_TIMEOUT 3000
+
+// board ip (dhcp) wait time per check_server() call (ms)
+#define IP_WAIT_TIMEOUT     10000
+
 #define TEST_MODEL_NONE 0
 #define TEST_MODEL_8GB  8
 #define TEST_MODEL_16GB 16
@@ -83,6 +102,12 @@ typedef struct client__t {
     // HDMI UI
     fb_info_t   *pfb;
     ui_grp_t    *pui;
+    const char  *fb_dev;    // -d : /dev/fb0 (HDMI), /dev/fb1 (vfb, headless)
+    const char  *snapshot;  // -s : framebuffer ppm dump at FINISH
+    int         bench;      // -b : rendering benchmark frames
+    int         layout;     // -L : build CONFIG_UI_BIN and exit
+    const char  *viewer;    // -r : remote fb viewer (ip[:port])
+    const char  *kms;       // -k : drm card, fb_dev(vfb) frame is shown by page flip
 
     int adc_fd;
     int channel;
@@ -91,6 +116,7 @@ typedef struct client__t {
     int eth_switch;     // 0 : stop, 1 : running
 
     char nlp_ip     [IP_ADDR_SIZE];
+    char board_ip   [IP_ADDR_SIZE];
     char efuse_data [EFUSE_UUID_SIZE +1];
     char mac        [MAC_STR_SIZE +1];
 }   client_t;
@@ -262,12 +288,12 @@ int errcode_print (client_t *p)
                 pos = 0, line++;
             }
             pos += sprintf (&err_msg[line][pos], "%s,", m2_item[i].name);
-            ui_set_ritem (p->pfb, p->pui, m2_item [i].ui_id, COLOR_RED, -1);
+            ui_ctrl_ritem (p->pfb, p->pui, m2_item [i].ui_id, COLOR_RED, -1);
         }
     }
     if (pos || line) {
         for (i = 0; i < line+1; i++) {
-            nlp_server_write (p->nlp_ip, NLP_SERVER_MSG_TYPE_ERR, &err_msg[i][0], 0);
+            server_send (NLP_SERVER_MSG_TYPE_ERR, &err_msg[i][0], 0);
             printf ("%s : msg = %s\n", __func__, &err_msg[i][0]);
         }
         return 1;
@@ -275,8 +301,60 @@ int errcode_print (client_t *p)
     return 0;
 }
 
+//------------------------------------------------------------------------------
+// item result/raw value stream to the server. sent once per result and value.
+//------------------------------------------------------------------------------
+#define ITEM_VALUE_SIZE 40
+
+struct item_stream {
+    // raw value (MB/s, mV, Mbits/sec, EDID bytes ...)
+    char value [ITEM_VALUE_SIZE +1];
+    // result +1 (0 : not sent)
+    int streamed;
+};
+
+static struct item_stream ItemStream [eITEM_END];
+
+static void item_value (int id, const char *value)
+{
+    struct item_stream *ps = &ItemStream[id];
+
+    if (strncmp (ps->value, value, ITEM_VALUE_SIZE)) {
+        memset  (ps->value, 0, sizeof(ps->value));
+        strncpy (ps->value, value, ITEM_VALUE_SIZE);
+        ps->streamed = 0;
+    }
+}
+
+static void item_stream (client_t *p, int id, const char *value)
+{
+    struct item_stream *ps = &ItemStream[id];
+
+    if (value)  item_value (id, value);
+
+    if (ps->streamed == (m2_item[id].result +1))
+        return;
+
+    if (server_result (p->channel, m2_item[id].name, m2_item[id].result, ps->value))
+        ps->streamed = m2_item[id].result +1;
+}
+
+//------------------------------------------------------------------------------
+// items stopped before the server was found.
+//------------------------------------------------------------------------------
+static void item_stream_flush (client_t *p)
+{
+    int i;
+
+    for (i = 0; i < eITEM_END; i++) {
+        if (m2_item[i].status == eSTATUS_STOP)
+            item_stream (p, i, NULL);
+    }
+}
+
 //------------------------------------------------------------------------------
 #define UI_STATUS   47
+#define UI_SYNC_TIMEOUT 1000
 #define	RUN_BOX_ON	RGB_TO_UINT(204, 204, 0)
 #define	RUN_BOX_OFF	RGB_TO_UINT(153, 153, 0)
 
@@ -288,23 +366,22 @@ void *check_status (void *arg)
     client_t *p = (client_t *)arg;
 
     while (TimeoutStop) {
-        ui_set_ritem (p->pfb, p->pui, ALIVE_DISPLAY_UI_ID,
+        ui_ctrl_ritem (p->pfb, p->pui, ALIVE_DISPLAY_UI_ID,
                     onoff ? COLOR_GREEN : p->pui->bc.uint, -1);
         onoff = !onoff;
 
         if (m2_item[eITEM_SERVER_IP].result && TimeoutStop) {
             memset (str, 0, sizeof(str));
             if (p->adc_fd != -1) {
-                ui_set_ritem (p->pfb, p->pui, UI_STATUS, onoff ? RUN_BOX_ON : RUN_BOX_OFF, -1);
+                ui_ctrl_ritem (p->pfb, p->pui, UI_STATUS, onoff ? RUN_BOX_ON : RUN_BOX_OFF, -1);
                 sprintf (str, "RUNNING %d", TimeoutStop);
             } else {
-                ui_set_ritem (p->pfb, p->pui, UI_STATUS, onoff ? COLOR_RED : p->pui->bc.uint, -1);
+                ui_ctrl_ritem (p->pfb, p->pui, UI_STATUS, onoff ? COLOR_RED : p->pui->bc.uint, -1);
                 sprintf (str, "I2CADC %d", TimeoutStop);
             }
-            ui_set_sitem (p->pfb, p->pui, UI_STATUS, -1, -1, str);
+            ui_ctrl_sitem (p->pfb, p->pui, UI_STATUS, -1, -1, str);
         }
         if (onoff) {
-            ui_update (p->pfb, p->pui, -1);
             if (TimeoutStop && (p->adc_fd != -1))   TimeoutStop--;
         }
 
@@ -334,20 +411,44 @@ void *check_status (void *arg)
     usleep (APP_LOOP_DELAY * 1000);
 
     if (m2_item [eITEM_MAC_ADDR].result)
-        nlp_server_write (p->nlp_ip, NLP_SERVER_MSG_TYPE_MAC, p->mac, p->channel);
-    ui_set_sitem (p->pfb, p->pui, UI_STATUS, -1, -1, str);
+        server_send (NLP_SERVER_MSG_TYPE_MAC, p->mac, p->channel);
+    ui_ctrl_sitem (p->pfb, p->pui, UI_STATUS, -1, -1, str);
     err = errcode_print (p);
-    ui_set_ritem (p->pfb, p->pui, UI_STATUS, err ? COLOR_RED : COLOR_GREEN, -1);
+    {
+        unsigned int skip, draw;
+        int rate = ui_ctrl_stats (&skip, &draw);
+
+        printf ("%s : ui unchanged item skip %d%% (skip = %u, drawn = %u)\n",
+                __func__, rate, skip, draw);
+    }
+    {
+        unsigned int opens, reads, writes;
+
+        sysfs_stats (&opens, &reads, &writes);
+        printf ("%s : sysfs open = %u, read = %u, write = %u\n",
+                __func__, opens, reads, writes);
+    }
+    {
+        unsigned int reads, hits;
+
+        adc_svc_stats (&reads, &hits);
+        printf ("%s : adc board read = %u, snapshot hit = %u\n",
+                __func__, reads, hits);
+    }
+    if (p->snapshot) {
+        ui_ctrl_sync (UI_SYNC_TIMEOUT);
+        ui_ctrl_snapshot (p->snapshot);
+    }
+    ui_ctrl_ritem (p->pfb, p->pui, UI_STATUS, err ? COLOR_RED : COLOR_GREEN, -1);
 
     while (1) {
         usleep (APP_LOOP_DELAY * 1000);
         onoff = !onoff;
 
         if (onoff)
-            ui_set_ritem (p->pfb, p->pui, UI_STATUS, err ? COLOR_RED : COLOR_GREEN, -1);
+            ui_ctrl_ritem (p->pfb, p->pui, UI_STATUS, err ? COLOR_RED : COLOR_GREEN, -1);
         else
-            ui_set_ritem (p->pfb, p->pui, UI_STATUS, p->pui->bc.uint, -1);
-        ui_update    (p->pfb, p->pui, -1);
+            ui_ctrl_ritem (p->pfb, p->pui, UI_STATUS, p->pui->bc.uint, -1);
     }
     return arg;
 }
@@ -355,38 +456,48 @@ void *check_status (void *arg)
 //------------------------------------------------------------------------------
 #define HP_DET_GPIO 61
 
-void *check_hp_detect (void *arg);
-void *check_hp_detect (void *arg)
+// kernel debounce (us), long press : MAC resend (ms)
+#define HP_DET_DEBOUNCE_US  10000
+#define HP_DET_LONG_PRESS   3000
+
+static void hp_det_update (client_t *p, int value)
 {
-    int value = 0, new_value = 0, long_press_cnt = 0;
+    int id = value ? eITEM_HP_DET_H : eITEM_HP_DET_L;
+
+    if (m2_item[id].status == eSTATUS_RUN) {
+        ui_ctrl_sitem (p->pfb, p->pui, m2_item[id].ui_id, -1, -1, "PASS");
+        ui_ctrl_ritem (p->pfb, p->pui, m2_item[id].ui_id, COLOR_GREEN, -1);
+        m2_item[id].result = eRESULT_PASS;
+        m2_item[id].status = eSTATUS_STOP;
+        item_stream (p, id, value ? "1" : "0");
+    }
+}
 
-    client_t *p = (client_t *)arg;
+//------------------------------------------------------------------------------
+static void hp_det_long_press (client_t *p)
+{
+    if (m2_item [eITEM_MAC_ADDR].result) {
+        tolowerstr (p->mac);
+        server_send (NLP_SERVER_MSG_TYPE_MAC, p->mac, p->channel);
+    }
+}
+
+//------------------------------------------------------------------------------
+// gpio cdev not available : sysfs polling (100ms)
+//------------------------------------------------------------------------------
+static void hp_det_poll (client_t *p)
+{
+    int value = 0, new_value = 0, long_press_cnt = 0;
 
     gpio_export    (HP_DET_GPIO);
     gpio_direction (HP_DET_GPIO, GPIO_DIR_IN);
     gpio_get_value (HP_DET_GPIO, &value);
 
-    m2_item[eITEM_HP_DET_H].status = m2_item[eITEM_HP_DET_L].status = eSTATUS_RUN;
     while (1) {
         if (gpio_get_value (HP_DET_GPIO, &new_value)) {
-
             if (value != new_value) {
                 value = new_value;
-                if (value) {
-                    if (m2_item[eITEM_HP_DET_H].status == eSTATUS_RUN) {
-                        ui_set_sitem (p->pfb, p->pui, m2_item[eITEM_HP_DET_H].ui_id, -1, -1, "PASS");
-                        ui_set_ritem (p->pfb, p->pui, m2_item[eITEM_HP_DET_H].ui_id, COLOR_GREEN, -1);
-                        m2_item[eITEM_HP_DET_H].result = eRESULT_PASS;
-                        m2_item[eITEM_HP_DET_H].status = eSTATUS_STOP;
-                    }
-                } else {
-                    if (m2_item[eITEM_HP_DET_L].status == eSTATUS_RUN) {
-                        ui_set_sitem (p->pfb, p->pui, m2_item[eITEM_HP_DET_L].ui_id, -1, -1, "PASS");
-                        ui_set_ritem (p->pfb, p->pui, m2_item[eITEM_HP_DET_L].ui_id, COLOR_GREEN, -1);
-                        m2_item[eITEM_HP_DET_L].result = eRESULT_PASS;
-                        m2_item[eITEM_HP_DET_L].status = eSTATUS_STOP;
-                    }
-                }
+                hp_det_update (p, value);
             }
         }
         usleep (100 * 1000);
@@ -394,37 +505,62 @@ void *check_hp_detect (void *arg)
         if (new_value)  long_press_cnt++;
         else            long_press_cnt = 0;
 
-        if (long_press_cnt > 30) {
+        if (long_press_cnt > (HP_DET_LONG_PRESS / 100)) {
             long_press_cnt = 0;
-            if (m2_item [eITEM_MAC_ADDR].result) {
-                tolowerstr (p->mac);
-                nlp_server_write (p->nlp_ip, NLP_SERVER_MSG_TYPE_MAC, p->mac, p->channel);
-            }
+            hp_det_long_press (p);
         }
     }
     gpio_unexport  (HP_DET_GPIO);
-    return arg;
 }
 
 //------------------------------------------------------------------------------
-#define SW_ADC_PATH "/sys/bus/iio/devices/iio:device0/in_voltage0_raw"
-
-// emmc : 1380 - 1390 - 1400
-// sd : 680 - 690 - 700
-int sw_adc_read (const char *path)
+void *check_hp_detect (void *arg);
+void *check_hp_detect (void *arg)
 {
-    char rdata[16];
-    FILE *fp;
-
-    memset (rdata, 0, sizeof (rdata));
-    // adc raw value get
-    if ((fp = fopen(path, "r")) != NULL) {
-        fgets (rdata, sizeof(rdata), fp);
-        fclose(fp);
+    int value = 0, new_value = 0, timeout, ret, fd;
+    unsigned long long press_ns = 0, ts_ns, elapsed;
+
+    client_t *p = (client_t *)arg;
+
+    m2_item[eITEM_HP_DET_H].status = m2_item[eITEM_HP_DET_L].status = eSTATUS_RUN;
+
+    // both edge event, blocked in poll while idle.
+    if ((fd = gpio_event_open (HP_DET_GPIO, HP_DET_DEBOUNCE_US, &value)) < 0) {
+        hp_det_poll (p);
+        return arg;
     }
-    return atoi(rdata);
+    if (value)  press_ns = gpio_event_now ();
+
+    while (1) {
+        timeout = -1;
+        // long press : from the rising edge timestamp
+        if (value) {
+            elapsed = (gpio_event_now () - press_ns) / 1000000;
+            if (elapsed >= HP_DET_LONG_PRESS) {
+                hp_det_long_press (p);
+                press_ns += HP_DET_LONG_PRESS * 1000000ULL;
+                continue;
+            }
+            timeout = HP_DET_LONG_PRESS - (int)elapsed;
+        }
+
+        if ((ret = gpio_event_wait (fd, timeout, &new_value, &ts_ns)) < 0)
+            break;
+        if (!ret || (new_value == value))
+            continue;
+
+        value = new_value;
+        if (value)  press_ns = ts_ns;
+        hp_det_update (p, value);
+    }
+    close (fd);
+    return arg;
 }
 
+//------------------------------------------------------------------------------
+// sw adc sample wait (buffered : first sample, sysfs : poll period)
+#define SW_ADC_PERIOD   100
+
 #define SW_eMMC_MIN 1380
 #define SW_eMMC_MAX 1400
 #define SW_uSD_MIN  680
@@ -436,23 +572,30 @@ void *check_sw_adc (void *arg);
 void *check_sw_adc (void *arg)
 {
     int value = 0, new_value = 0, status = 0, adc_value = 0;
+    char str[16];
+
+    int error = 0;
 
     client_t *p = (client_t *)arg;
 
+    sw_adc_init ();
     while (1) {
-	usleep (100 * 1000);
-        adc_value = sw_adc_read (SW_ADC_PATH);
+        if ((adc_value = sw_adc_read (SW_ADC_PERIOD)) < 0)
+            continue;
         if ((SW_eMMC_MIN < adc_value) && (SW_eMMC_MAX > adc_value ))
         {   value = 0;  break; }
 
         if ((SW_uSD_MIN < adc_value) && (SW_uSD_MAX > adc_value ))
         {   value = 1;  break; }
-        printf ("sw adc value error! (emmc:1380~1400, sd:680~700) : %d\n", adc_value);
+        // report once per second while the switch is between positions.
+        if (!(error++ % (1000 / SW_ADC_PERIOD)))
+            printf ("sw adc value error! (emmc:1380~1400, sd:680~700) : %d\n", adc_value);
     }
     new_value = value;
     m2_item[eITEM_SW_uSD].status = m2_item[eITEM_SW_eMMC].status = eSTATUS_RUN;
     while (TimeoutStop) {
-        adc_value = sw_adc_read (SW_ADC_PATH);
+        if ((adc_value = sw_adc_read (SW_ADC_PERIOD)) < 0)
+            continue;
 
         if ((SW_eMMC_MIN < adc_value) && (SW_eMMC_MAX > adc_value))
             new_value = 0;
@@ -464,24 +607,62 @@ void *check_sw_adc (void *arg)
             value = new_value;
             status |= value ? 0x02 : 0x01;
 
+            memset (str, 0, sizeof(str));   sprintf (str, "%d", adc_value);
+            item_value (value ? eITEM_SW_uSD : eITEM_SW_eMMC, str);
             if (value) {
                 m2_item[eITEM_SW_uSD].result = eRESULT_PASS;
-                ui_set_sitem (p->pfb, p->pui, m2_item[eITEM_SW_uSD].ui_id, -1, -1, "PASS");
-                ui_set_ritem (p->pfb, p->pui, m2_item[eITEM_SW_uSD].ui_id, COLOR_GREEN, -1);
+                ui_ctrl_sitem (p->pfb, p->pui, m2_item[eITEM_SW_uSD].ui_id, -1, -1, "PASS");
+                ui_ctrl_ritem (p->pfb, p->pui, m2_item[eITEM_SW_uSD].ui_id, COLOR_GREEN, -1);
             } else {
                 m2_item[eITEM_SW_eMMC].result = eRESULT_PASS;
-                ui_set_sitem (p->pfb, p->pui, m2_item[eITEM_SW_eMMC].ui_id, -1, -1, "PASS");
-                ui_set_ritem (p->pfb, p->pui, m2_item[eITEM_SW_eMMC].ui_id, COLOR_GREEN, -1);
+                ui_ctrl_sitem (p->pfb, p->pui, m2_item[eITEM_SW_eMMC].ui_id, -1, -1, "PASS");
+                ui_ctrl_ritem (p->pfb, p->pui, m2_item[eITEM_SW_eMMC].ui_id, COLOR_GREEN, -1);
             }
         }
 
-        usleep (100 * 1000);
         if (m2_item[eITEM_SW_uSD].result && m2_item[eITEM_SW_eMMC].result) break;
     }
     m2_item[eITEM_SW_uSD].status = m2_item[eITEM_SW_eMMC].status = eSTATUS_STOP;
+    sw_adc_close ();
+    item_stream (p, eITEM_SW_eMMC, NULL);
+    item_stream (p, eITEM_SW_uSD,  NULL);
     return arg;
 }
 
+//------------------------------------------------------------------------------
+// MAC/PHY loopback self-test. Runs at boot before the server discovery (no peer
+// needed), so a MAC/PHY fault that blocks DHCP or discovery is still reported.
+// The offline test forces the speed (autoneg off) and takes the eth0 link down,
+// the autoneg is restored before check_server() needs the link.
+// A failed speed is reported immediately, the link switch test checks the rest.
+//------------------------------------------------------------------------------
+static int check_ethernet_loopback (client_t *p)
+{
+    int i, value, speed[2] = { LINK_SPEED_100M, LINK_SPEED_1G };
+    int item[2] = { eITEM_ETHERNET_100M, eITEM_ETHERNET_1G };
+
+    for (i = 0; i < 2; i++) {
+        ui_ctrl_ritem (p->pfb, p->pui, m2_item[item[i]].ui_id, COLOR_YELLOW, -1);
+        value = ethernet_self_test (speed[i]);
+
+        // not supported(-1) : wait for the link switch test.
+        if (value < 0) {
+            ui_ctrl_ritem (p->pfb, p->pui, m2_item[item[i]].ui_id, p->pui->bc.uint, -1);
+            continue;
+        }
+        ui_ctrl_sitem (p->pfb, p->pui, m2_item[item[i]].ui_id, -1, -1, value ? "LOOP" : "FAIL");
+        ui_ctrl_ritem (p->pfb, p->pui, m2_item[item[i]].ui_id,
+                        value ? p->pui->bc.uint : COLOR_RED, -1);
+        if (!value) {
+            m2_item[item[i]].result = eRESULT_FAIL;
+            m2_item[item[i]].status = eSTATUS_STOP;
+            item_stream (p, item[i], "loopback");
+        }
+    }
+    ethernet_self_test_end ();
+    return 1;
+}
+
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
 #define UI_ETHERNET_SWITCH  154
@@ -491,7 +672,11 @@ void *check_device_ethernet (void *arg)
     int speed;
     client_t *p = (client_t *)arg;
 
-    m2_item[eITEM_ETHERNET_100M].status = m2_item[eITEM_ETHERNET_1G].status = eSTATUS_RUN;
+    // loopback fail items are already stopped.
+    if (m2_item[eITEM_ETHERNET_100M].status != eSTATUS_STOP)
+        m2_item[eITEM_ETHERNET_100M].status = eSTATUS_RUN;
+    if (m2_item[eITEM_ETHERNET_1G].status != eSTATUS_STOP)
+        m2_item[eITEM_ETHERNET_1G].status = eSTATUS_RUN;
 
     // ethernet switch thread run
     p->eth_switch = 1;
@@ -499,19 +684,23 @@ void *check_device_ethernet (void *arg)
     while (TimeoutStop) {
         switch (speed) {
             case LINK_SPEED_1G:
-                if (ethernet_link_setup (LINK_SPEED_100M)) {
+                if (ethernet_link_setup (LINK_SPEED_100M) &&
+                    (m2_item[eITEM_ETHERNET_100M].status == eSTATUS_RUN)) {
                     m2_item[eITEM_ETHERNET_100M].status = eSTATUS_STOP;
                     m2_item[eITEM_ETHERNET_100M].result = eRESULT_PASS;
-                    ui_set_sitem (p->pfb, p->pui, m2_item[eITEM_ETHERNET_100M].ui_id, -1, -1, "PASS");
-                    ui_set_ritem (p->pfb, p->pui, m2_item[eITEM_ETHERNET_100M].ui_id, COLOR_GREEN, -1);
+                    item_stream (p, eITEM_ETHERNET_100M, "100");
+                    ui_ctrl_sitem (p->pfb, p->pui, m2_item[eITEM_ETHERNET_100M].ui_id, -1, -1, "PASS");
+                    ui_ctrl_ritem (p->pfb, p->pui, m2_item[eITEM_ETHERNET_100M].ui_id, COLOR_GREEN, -1);
                 }
                 break;
             case LINK_SPEED_100M:
-                if (ethernet_link_setup (LINK_SPEED_1G)) {
+                if (ethernet_link_setup (LINK_SPEED_1G) &&
+                    (m2_item[eITEM_ETHERNET_1G].status == eSTATUS_RUN)) {
                     m2_item[eITEM_ETHERNET_1G].status = eSTATUS_STOP;
                     m2_item[eITEM_ETHERNET_1G].result = eRESULT_PASS;
-                    ui_set_sitem (p->pfb, p->pui, m2_item[eITEM_ETHERNET_1G].ui_id, -1, -1, "PASS");
-                    ui_set_ritem (p->pfb, p->pui, m2_item[eITEM_ETHERNET_1G].ui_id, COLOR_GREEN, -1);
+                    item_stream (p, eITEM_ETHERNET_1G, "1000");
+                    ui_ctrl_sitem (p->pfb, p->pui, m2_item[eITEM_ETHERNET_1G].ui_id, -1, -1, "PASS");
+                    ui_ctrl_ritem (p->pfb, p->pui, m2_item[eITEM_ETHERNET_1G].ui_id, COLOR_GREEN, -1);
                 }
                 break;
             default :
@@ -521,11 +710,11 @@ void *check_device_ethernet (void *arg)
 
         if (m2_item [eITEM_ETHERNET_1G].result && m2_item [eITEM_ETHERNET_100M].result) {
             if (speed == LINK_SPEED_100M)
-                ui_set_sitem (p->pfb, p->pui, UI_ETHERNET_SWITCH, -1, -1, "GREEN");
+                ui_ctrl_sitem (p->pfb, p->pui, UI_ETHERNET_SWITCH, -1, -1, "GREEN");
             else
-                ui_set_sitem (p->pfb, p->pui, UI_ETHERNET_SWITCH, -1, -1, "ORANGE");
+                ui_ctrl_sitem (p->pfb, p->pui, UI_ETHERNET_SWITCH, -1, -1, "ORANGE");
 
-            ui_set_ritem (p->pfb, p->pui, UI_ETHERNET_SWITCH, RUN_BOX_ON, -1);
+            ui_ctrl_ritem (p->pfb, p->pui, UI_ETHERNET_SWITCH, RUN_BOX_ON, -1);
         }
         usleep (APP_LOOP_DELAY * 1000);
     }
@@ -546,39 +735,42 @@ void *check_device_usb (void *arg)
         // USB30
         if (!m2_item[eITEM_USB30].result) {
             m2_item[eITEM_USB30].status = eSTATUS_RUN;
-            ui_set_ritem (p->pfb, p->pui, m2_item[eITEM_USB30].ui_id, COLOR_YELLOW, -1);
+            ui_ctrl_ritem (p->pfb, p->pui, m2_item[eITEM_USB30].ui_id, COLOR_YELLOW, -1);
             value = usb_check (eUSB_30);
             memset (str, 0, sizeof(str));   sprintf(str, "%d MB/s", value);
-            ui_set_sitem (p->pfb, p->pui, m2_item[eITEM_USB30].ui_id, -1, -1, str);
-            ui_set_ritem (p->pfb, p->pui, m2_item[eITEM_USB30].ui_id, (value > 100) ? COLOR_GREEN : COLOR_RED, -1);
+            ui_ctrl_sitem (p->pfb, p->pui, m2_item[eITEM_USB30].ui_id, -1, -1, str);
+            ui_ctrl_ritem (p->pfb, p->pui, m2_item[eITEM_USB30].ui_id, (value > 100) ? COLOR_GREEN : COLOR_RED, -1);
             m2_item[eITEM_USB30].result = (value > 100) ? eRESULT_PASS : eRESULT_FAIL;
             m2_item[eITEM_USB30].status = eSTATUS_STOP;
+            item_stream (p, eITEM_USB30, str);
         }
 
         // USB20
         if (!m2_item[eITEM_USB20].result) {
             m2_item[eITEM_USB20].status = eSTATUS_RUN;
-            ui_set_ritem (p->pfb, p->pui, m2_item[eITEM_USB20].ui_id, COLOR_YELLOW, -1);
+            ui_ctrl_ritem (p->pfb, p->pui, m2_item[eITEM_USB20].ui_id, COLOR_YELLOW, -1);
             value = usb_check (eUSB_20);
             memset (str, 0, sizeof(str));   sprintf(str, "%d MB/s", value);
 
-            ui_set_sitem (p->pfb, p->pui, m2_item[eITEM_USB20].ui_id, -1, -1, str);
-            ui_set_ritem (p->pfb, p->pui, m2_item[eITEM_USB20].ui_id, (value > 25) ? COLOR_GREEN : COLOR_RED, -1);
+            ui_ctrl_sitem (p->pfb, p->pui, m2_item[eITEM_USB20].ui_id, -1, -1, str);
+            ui_ctrl_ritem (p->pfb, p->pui, m2_item[eITEM_USB20].ui_id, (value > 25) ? COLOR_GREEN : COLOR_RED, -1);
             m2_item[eITEM_USB20].result = (value > 30) ? eRESULT_PASS : eRESULT_FAIL;
             m2_item[eITEM_USB20].status = eSTATUS_STOP;
+            item_stream (p, eITEM_USB20, str);
         }
 
         // USB_C
         if (!m2_item[eITEM_USB_C].result) {
             m2_item[eITEM_USB_C].status = eSTATUS_RUN;
-            ui_set_ritem (p->pfb, p->pui, m2_item[eITEM_USB_C].ui_id, COLOR_YELLOW, -1);
+            ui_ctrl_ritem (p->pfb, p->pui, m2_item[eITEM_USB_C].ui_id, COLOR_YELLOW, -1);
             value = usb_check (eUSB_C);
             memset (str, 0, sizeof(str));   sprintf(str, "%d MB/s", value);
 
-            ui_set_sitem (p->pfb, p->pui, m2_item[eITEM_USB_C].ui_id, -1, -1, str);
-            ui_set_ritem (p->pfb, p->pui, m2_item[eITEM_USB_C].ui_id, (value > 100) ? COLOR_GREEN : COLOR_RED, -1);
+            ui_ctrl_sitem (p->pfb, p->pui, m2_item[eITEM_USB_C].ui_id, -1, -1, str);
+            ui_ctrl_ritem (p->pfb, p->pui, m2_item[eITEM_USB_C].ui_id, (value > 100) ? COLOR_GREEN : COLOR_RED, -1);
             m2_item[eITEM_USB_C].result = (value > 100) ? eRESULT_PASS : eRESULT_FAIL;
             m2_item[eITEM_USB_C].status = eSTATUS_STOP;
+            item_stream (p, eITEM_USB_C, str);
         }
         if (m2_item[eITEM_USB30].result && m2_item[eITEM_USB20].result && m2_item[eITEM_USB_C].result)
             break;
@@ -588,35 +780,108 @@ void *check_device_usb (void *arg)
     return arg;
 }
 
+//------------------------------------------------------------------------------
+// header pin settle : adc sample interval, tolerance (mV), max wait (ms).
+// all patterns settle within HEADER_SETTLE_TOTAL (old 4 pattern test time).
+#define HEADER_SETTLE_INTERVAL  10
+#define HEADER_SETTLE_TOL       50
+#define HEADER_SETTLE_TOTAL     2000
+#define HEADER_SETTLE_MAX       (HEADER_SETTLE_TOTAL / HEADER_PATTERN_COUNT)
+
+static int header_adc_read (client_t *p, int *pattern40, int *pattern14)
+{
+    int cnt = 0;
+
+    memset (pattern40, 0, sizeof(int) * (40 +1));
+    memset (pattern14, 0, sizeof(int) * (14 +1));
+    if (p->adc_fd <= 0)
+        return 0;
+    // settle compares consecutive samples : always a new snapshot.
+    adc_svc_read ( "CON1", 0, &pattern40[1],  &cnt);
+    adc_svc_read ("P13.6", 0, &pattern14[13], &cnt);
+    return cnt;
+}
+
+//------------------------------------------------------------------------------
+// sample until two reads agree within HEADER_SETTLE_TOL on every channel.
+// return : settle time (ms), HEADER_SETTLE_MAX if not settled.
+//------------------------------------------------------------------------------
+static int header_adc_settle (client_t *p, int *pattern40, int *pattern14)
+{
+    int prev40[40 +1], prev14[14 +1], i, stable;
+    struct timespec start, now;
+    int ms = 0;
+
+    clock_gettime (CLOCK_MONOTONIC, &start);
+    header_adc_read (p, prev40, prev14);
+
+    while (ms < HEADER_SETTLE_MAX) {
+        usleep (HEADER_SETTLE_INTERVAL * 1000);
+        header_adc_read (p, pattern40, pattern14);
+
+        for (i = 0, stable = 1; (i < 40 +1) && stable; i++)
+            if (abs (pattern40[i] - prev40[i]) > HEADER_SETTLE_TOL)  stable = 0;
+        for (i = 0; (i < 14 +1) && stable; i++)
+            if (abs (pattern14[i] - prev14[i]) > HEADER_SETTLE_TOL)  stable = 0;
+
+        clock_gettime (CLOCK_MONOTONIC, &now);
+        ms = (now.tv_sec - start.tv_sec) * 1000 + (now.tv_nsec - start.tv_nsec) / 1000000;
+        if (stable)
+            return ms;
+
+        memcpy (prev40, pattern40, sizeof(prev40));
+        memcpy (prev14, pattern14, sizeof(prev14));
+    }
+    return HEADER_SETTLE_MAX;
+}
+
 //------------------------------------------------------------------------------
 static int check_header (client_t *p)
 {
     static int init = 0;
     int ui_id = m2_item[eITEM_HEADER_PT1].ui_id, i;
-    int pattern40[40 +1], pattern14[14 +1], cnt;
+    int pattern40[40 +1], pattern14[14 +1], settle = 0;
+    char fail[ITEM_VALUE_SIZE +1];
 
     if (!init)  {   header_init (); init = 1; }
 
     for (i = 0; i < eHEADER_END; i++) {
-        if (!m2_item[eITEM_HEADER_PT1 + i].result) {
-            ui_set_ritem (p->pfb, p->pui, ui_id + i, COLOR_YELLOW, -1);
-            m2_item[eITEM_HEADER_PT1 + i].status = eSTATUS_RUN;
-            header_pattern_set   (i);   usleep (APP_LOOP_DELAY * 1000);
-            memset (pattern40, 0, sizeof(pattern40));
-            memset (pattern14, 0, sizeof(pattern14));
-            adc_board_read (p->adc_fd,  "CON1", &pattern40[1],  &cnt);
-            adc_board_read (p->adc_fd, "P13.6", &pattern14[13], &cnt);
-            if (header_pattern_check (i, pattern40, pattern14)) {
-                m2_item[eITEM_HEADER_PT1 + i].result = eRESULT_PASS;
-                ui_set_sitem (p->pfb, p->pui, ui_id + i, -1, -1, "PASS");
-                ui_set_ritem (p->pfb, p->pui, ui_id + i, COLOR_GREEN, -1);
-            } else {
-                m2_item[eITEM_HEADER_PT1 + i].result = eRESULT_FAIL;
-                ui_set_sitem (p->pfb, p->pui, ui_id + i, -1, -1, "FAIL");
-                ui_set_ritem (p->pfb, p->pui, ui_id + i, COLOR_RED, -1);
-            }
-            m2_item[eITEM_HEADER_PT1 + i].status = eSTATUS_STOP;
+        if (!m2_item[eITEM_HEADER_PT1 + i].result)
+            break;
+    }
+    if (i == eHEADER_END)
+        return 1;
+
+    for (i = 0; i < eHEADER_END; i++) {
+        if (m2_item[eITEM_HEADER_PT1 + i].result)
+            continue;
+        ui_ctrl_ritem (p->pfb, p->pui, ui_id + i, COLOR_YELLOW, -1);
+        m2_item[eITEM_HEADER_PT1 + i].status = eSTATUS_RUN;
+    }
+
+    // all patterns, then the fault type of every pin.
+    for (i = 0; i < HEADER_PATTERN_COUNT; i++) {
+        header_pattern_set  (i);
+        settle += header_adc_settle (p, pattern40, pattern14);
+        header_pattern_read (i, pattern40, pattern14);
+    }
+    printf ("%s : %d patterns, settle %d ms\n", __func__, HEADER_PATTERN_COUNT, settle);
+
+    // PT1 : stuck low, PT2 : stuck high, PT3 : short ("3=5"), PT4 : level error
+    for (i = 0; i < eHEADER_END; i++) {
+        if (m2_item[eITEM_HEADER_PT1 + i].result)
+            continue;
+        if (!header_pattern_check (i, fail, sizeof(fail))) {
+            m2_item[eITEM_HEADER_PT1 + i].result = eRESULT_PASS;
+            ui_ctrl_sitem (p->pfb, p->pui, ui_id + i, -1, -1, "PASS");
+            ui_ctrl_ritem (p->pfb, p->pui, ui_id + i, COLOR_GREEN, -1);
+        } else {
+            m2_item[eITEM_HEADER_PT1 + i].result = eRESULT_FAIL;
+            ui_ctrl_sitem (p->pfb, p->pui, ui_id + i, -1, -1, fail);
+            ui_ctrl_ritem (p->pfb, p->pui, ui_id + i, COLOR_RED, -1);
         }
+        m2_item[eITEM_HEADER_PT1 + i].status = eSTATUS_STOP;
+        item_stream (p, eITEM_HEADER_PT1 + i, fail);
     }
     return 1;
 }
@@ -634,43 +899,52 @@ void *check_device_storage (void *arg)
         if (!m2_item [eITEM_eMMC].result) {
             m2_item[eITEM_eMMC].status = eSTATUS_RUN;
 
-            ui_set_ritem (p->pfb, p->pui, m2_item[eITEM_eMMC].ui_id, COLOR_YELLOW, -1);
+            ui_ctrl_ritem (p->pfb, p->pui, m2_item[eITEM_eMMC].ui_id, COLOR_YELLOW, -1);
             value = storage_check (eSTORAGE_eMMC);
             memset (str, 0, sizeof(str));   sprintf(str, "%d MB/s", value);
 
-            ui_set_sitem (p->pfb, p->pui, m2_item[eITEM_eMMC].ui_id, -1, -1, str);
-            ui_set_ritem (p->pfb, p->pui, m2_item[eITEM_eMMC].ui_id, value ? COLOR_GREEN : COLOR_RED, -1);
+            ui_ctrl_sitem (p->pfb, p->pui, m2_item[eITEM_eMMC].ui_id, -1, -1, str);
+            ui_ctrl_ritem (p->pfb, p->pui, m2_item[eITEM_eMMC].ui_id, value ? COLOR_GREEN : COLOR_RED, -1);
             m2_item[eITEM_eMMC].result = value ? eRESULT_PASS : eRESULT_FAIL;
 
-            if (m2_item[eITEM_eMMC].result) m2_item[eITEM_eMMC].status = eSTATUS_STOP;
+            if (m2_item[eITEM_eMMC].result) {
+                m2_item[eITEM_eMMC].status = eSTATUS_STOP;
+                item_stream (p, eITEM_eMMC, str);
+            }
         }
 
         // uSD
         if (!m2_item [eITEM_uSD].result) {
             m2_item[eITEM_uSD].status = eSTATUS_RUN;
-            ui_set_ritem (p->pfb, p->pui, m2_item[eITEM_uSD].ui_id, COLOR_YELLOW, -1);
+            ui_ctrl_ritem (p->pfb, p->pui, m2_item[eITEM_uSD].ui_id, COLOR_YELLOW, -1);
             value = storage_check (eSTORAGE_uSD);
             memset (str, 0, sizeof(str));   sprintf(str, "%d MB/s", value);
 
-            ui_set_sitem (p->pfb, p->pui, m2_item[eITEM_uSD].ui_id, -1, -1, str);
-            ui_set_ritem (p->pfb, p->pui, m2_item[eITEM_uSD].ui_id, value ? COLOR_GREEN : COLOR_RED, -1);
+            ui_ctrl_sitem (p->pfb, p->pui, m2_item[eITEM_uSD].ui_id, -1, -1, str);
+            ui_ctrl_ritem (p->pfb, p->pui, m2_item[eITEM_uSD].ui_id, value ? COLOR_GREEN : COLOR_RED, -1);
             m2_item[eITEM_uSD].result = value ? eRESULT_PASS : eRESULT_FAIL;
 
-            if (m2_item[eITEM_uSD].result)  m2_item[eITEM_uSD].status = eSTATUS_STOP;
+            if (m2_item[eITEM_uSD].result) {
+                m2_item[eITEM_uSD].status = eSTATUS_STOP;
+                item_stream (p, eITEM_uSD, str);
+            }
         }
 
         // NVME
         if (!m2_item [eITEM_NVME].result) {
             m2_item[eITEM_NVME].status = eSTATUS_RUN;
-            ui_set_ritem (p->pfb, p->pui, m2_item[eITEM_NVME].ui_id, COLOR_YELLOW, -1);
+            ui_ctrl_ritem (p->pfb, p->pui, m2_item[eITEM_NVME].ui_id, COLOR_YELLOW, -1);
             value = storage_check (eSTORAGE_NVME);
             memset (str, 0, sizeof(str));   sprintf(str, "%d MB/s", value);
 
-            ui_set_sitem (p->pfb, p->pui, m2_item[eITEM_NVME].ui_id, -1, -1, str);
-            ui_set_ritem (p->pfb, p->pui, m2_item[eITEM_NVME].ui_id, value ? COLOR_GREEN : COLOR_RED, -1);
+            ui_ctrl_sitem (p->pfb, p->pui, m2_item[eITEM_NVME].ui_id, -1, -1, str);
+            ui_ctrl_ritem (p->pfb, p->pui, m2_item[eITEM_NVME].ui_id, value ? COLOR_GREEN : COLOR_RED, -1);
             m2_item[eITEM_NVME].result = value ? eRESULT_PASS : eRESULT_FAIL;
 
-            if (m2_item[eITEM_NVME].result) m2_item[eITEM_NVME].status = eSTATUS_STOP;
+            if (m2_item[eITEM_NVME].result) {
+                m2_item[eITEM_NVME].status = eSTATUS_STOP;
+                item_stream (p, eITEM_NVME, str);
+            }
         }
         if (m2_item [eITEM_eMMC].result && m2_item [eITEM_uSD].result && m2_item [eITEM_NVME].result)
             break;
@@ -689,35 +963,38 @@ static int check_device_system (client_t *p)
 //    if (!m2_item[eITEM_MEM].result && TimeoutStop) {
     if (TimeoutStop) {
         m2_item[eITEM_MEM].status = eSTATUS_RUN;
-        ui_set_ritem (p->pfb, p->pui, m2_item[eITEM_MEM].ui_id, COLOR_YELLOW, -1);
+        ui_ctrl_ritem (p->pfb, p->pui, m2_item[eITEM_MEM].ui_id, COLOR_YELLOW, -1);
         value = system_check (eSYSTEM_MEM);
         p->board_mem = value;
         memset (str, 0, sizeof(str));
         if (p->test_model) {
             sprintf (str, "%d / T-%d GB", p->board_mem, p->test_model);
-            ui_set_sitem (p->pfb, p->pui, m2_item[eITEM_MEM].ui_id, -1, -1, str);
-            ui_set_ritem (p->pfb, p->pui, m2_item[eITEM_MEM].ui_id,
+            ui_ctrl_sitem (p->pfb, p->pui, m2_item[eITEM_MEM].ui_id, -1, -1, str);
+            ui_ctrl_ritem (p->pfb, p->pui, m2_item[eITEM_MEM].ui_id,
                             (p->test_model == p->board_mem) ? COLOR_GREEN : COLOR_RED, -1);
         } else {
             sprintf(str, "%d GB", value);
-            ui_set_sitem (p->pfb, p->pui, m2_item[eITEM_MEM].ui_id, -1, -1, str);
-            ui_set_ritem (p->pfb, p->pui, m2_item[eITEM_MEM].ui_id, value ? COLOR_GREEN : COLOR_RED, -1);
+            ui_ctrl_sitem (p->pfb, p->pui, m2_item[eITEM_MEM].ui_id, -1, -1, str);
+            ui_ctrl_ritem (p->pfb, p->pui, m2_item[eITEM_MEM].ui_id, value ? COLOR_GREEN : COLOR_RED, -1);
             m2_item[eITEM_MEM].result = value ? eRESULT_PASS : eRESULT_FAIL;
         }
         m2_item[eITEM_MEM].status = eSTATUS_STOP;
+        memset (str, 0, sizeof(str));   sprintf (str, "%d", value);
+        item_stream (p, eITEM_MEM, str);
     }
 
     // FB
     if (!m2_item[eITEM_FB].result) {
         m2_item[eITEM_FB].status = eSTATUS_RUN;
-        ui_set_ritem (p->pfb, p->pui, m2_item[eITEM_FB].ui_id, COLOR_YELLOW, -1);
+        ui_ctrl_ritem (p->pfb, p->pui, m2_item[eITEM_FB].ui_id, COLOR_YELLOW, -1);
         value = system_check (eSYSTEM_FB_Y);
         memset (str, 0, sizeof(str));   sprintf(str, "%dP", value);
 
-        ui_set_sitem (p->pfb, p->pui, m2_item[eITEM_FB].ui_id, -1, -1, str);
-        ui_set_ritem (p->pfb, p->pui, m2_item[eITEM_FB].ui_id, (value == 1080) ? COLOR_GREEN : COLOR_RED, -1);
+        ui_ctrl_sitem (p->pfb, p->pui, m2_item[eITEM_FB].ui_id, -1, -1, str);
+        ui_ctrl_ritem (p->pfb, p->pui, m2_item[eITEM_FB].ui_id, (value == 1080) ? COLOR_GREEN : COLOR_RED, -1);
         m2_item[eITEM_FB].result = (value == 1080) ? eRESULT_PASS : eRESULT_FAIL;
         m2_item[eITEM_FB].status = eSTATUS_STOP;
+        item_stream (p, eITEM_FB, str);
     }
 
     if (p->test_model && (p->test_model != p->board_mem))
@@ -727,30 +1004,37 @@ static int check_device_system (client_t *p)
 }
 
 //------------------------------------------------------------------------------
+#define EDID_STREAM_BYTES   (ITEM_VALUE_SIZE / 2)
+
 static int check_device_hdmi (client_t *p)
 {
     int value = 0;
+    char str[ITEM_VALUE_SIZE +1];
 
     // EDID
     if (!m2_item[eITEM_EDID].result) {
         m2_item[eITEM_EDID].status = eSTATUS_RUN;
-        ui_set_ritem (p->pfb, p->pui, m2_item[eITEM_EDID].ui_id, COLOR_YELLOW, -1);
+        ui_ctrl_ritem (p->pfb, p->pui, m2_item[eITEM_EDID].ui_id, COLOR_YELLOW, -1);
         value = hdmi_check (eHDMI_EDID);
-        ui_set_sitem (p->pfb, p->pui, m2_item[eITEM_EDID].ui_id, -1, -1, value ? "PASS":"FAIL");
-        ui_set_ritem (p->pfb, p->pui, m2_item[eITEM_EDID].ui_id, value ? COLOR_GREEN : COLOR_RED, -1);
+        ui_ctrl_sitem (p->pfb, p->pui, m2_item[eITEM_EDID].ui_id, -1, -1, value ? "PASS":"FAIL");
+        ui_ctrl_ritem (p->pfb, p->pui, m2_item[eITEM_EDID].ui_id, value ? COLOR_GREEN : COLOR_RED, -1);
         m2_item[eITEM_EDID].result = value ? eRESULT_PASS : eRESULT_FAIL;
         m2_item[eITEM_EDID].status = eSTATUS_STOP;
+        memset (str, 0, sizeof(str));   hdmi_data (eHDMI_EDID, str, EDID_STREAM_BYTES);
+        item_stream (p, eITEM_EDID, str);
     }
 
     // HPD
     if (!m2_item[eITEM_HPD].result) {
         m2_item[eITEM_HPD].status = eSTATUS_RUN;
-        ui_set_ritem (p->pfb, p->pui, m2_item[eITEM_HPD].ui_id, COLOR_YELLOW, -1);
+        ui_ctrl_ritem (p->pfb, p->pui, m2_item[eITEM_HPD].ui_id, COLOR_YELLOW, -1);
         value = hdmi_check (eHDMI_HPD);
-        ui_set_sitem (p->pfb, p->pui, m2_item[eITEM_HPD].ui_id, -1, -1, value ? "PASS":"FAIL");
-        ui_set_ritem (p->pfb, p->pui, m2_item[eITEM_HPD].ui_id, value ? COLOR_GREEN : COLOR_RED, -1);
+        ui_ctrl_sitem (p->pfb, p->pui, m2_item[eITEM_HPD].ui_id, -1, -1, value ? "PASS":"FAIL");
+        ui_ctrl_ritem (p->pfb, p->pui, m2_item[eITEM_HPD].ui_id, value ? COLOR_GREEN : COLOR_RED, -1);
         m2_item[eITEM_HPD].result = value ? eRESULT_PASS : eRESULT_FAIL;
         m2_item[eITEM_HPD].status = eSTATUS_STOP;
+        memset (str, 0, sizeof(str));   hdmi_data (eHDMI_HPD, str, ITEM_VALUE_SIZE);
+        item_stream (p, eITEM_HPD, str);
     }
 
     return 1;
@@ -765,25 +1049,27 @@ static int check_device_adc (client_t *p)
     // ADC37
     if (!m2_item[eITEM_ADC37].result) {
         m2_item[eITEM_ADC37].status = eSTATUS_RUN;
-        ui_set_ritem (p->pfb, p->pui, m2_item[eITEM_ADC37].ui_id, COLOR_YELLOW, -1);
+        ui_ctrl_ritem (p->pfb, p->pui, m2_item[eITEM_ADC37].ui_id, COLOR_YELLOW, -1);
         adc_value = adc_check (eADC_H37);
         memset  (str, 0, sizeof(str));  sprintf (str, "%d", adc_value);
-        ui_set_sitem (p->pfb, p->pui, m2_item[eITEM_ADC37].ui_id, -1, -1, str);
-        ui_set_ritem (p->pfb, p->pui, m2_item[eITEM_ADC37].ui_id, adc_value ? COLOR_GREEN : COLOR_RED, -1);
+        ui_ctrl_sitem (p->pfb, p->pui, m2_item[eITEM_ADC37].ui_id, -1, -1, str);
+        ui_ctrl_ritem (p->pfb, p->pui, m2_item[eITEM_ADC37].ui_id, adc_value ? COLOR_GREEN : COLOR_RED, -1);
         m2_item[eITEM_ADC37].result = adc_value ? eRESULT_PASS : eRESULT_FAIL;
         m2_item[eITEM_ADC37].status = eSTATUS_STOP;
+        item_stream (p, eITEM_ADC37, str);
     }
 
     // ADC40
     if (!m2_item[eITEM_ADC40].result) {
         m2_item[eITEM_ADC40].status = eSTATUS_RUN;
-        ui_set_ritem (p->pfb, p->pui, m2_item[eITEM_ADC40].ui_id, COLOR_YELLOW, -1);
+        ui_ctrl_ritem (p->pfb, p->pui, m2_item[eITEM_ADC40].ui_id, COLOR_YELLOW, -1);
         adc_value = adc_check (eADC_H40);
         memset  (str, 0, sizeof(str));  sprintf (str, "%d", adc_value);
-        ui_set_sitem (p->pfb, p->pui, m2_item[eITEM_ADC40].ui_id, -1, -1, str);
-        ui_set_ritem (p->pfb, p->pui, m2_item[eITEM_ADC40].ui_id, adc_value ? COLOR_GREEN : COLOR_RED, -1);
+        ui_ctrl_sitem (p->pfb, p->pui, m2_item[eITEM_ADC40].ui_id, -1, -1, str);
+        ui_ctrl_ritem (p->pfb, p->pui, m2_item[eITEM_ADC40].ui_id, adc_value ? COLOR_GREEN : COLOR_RED, -1);
         m2_item[eITEM_ADC40].result = adc_value ? eRESULT_PASS : eRESULT_FAIL;
         m2_item[eITEM_ADC40].status = eSTATUS_STOP;
+        item_stream (p, eITEM_ADC40, str);
     }
     return 1;
 }
@@ -796,7 +1082,7 @@ static int check_mac_addr (client_t *p)
     efuse_set_board (eBOARD_ID_M2);
 
     m2_item[eITEM_MAC_ADDR].status = eSTATUS_RUN;
-    ui_set_ritem (p->pfb, p->pui, m2_item [eITEM_MAC_ADDR].ui_id, COLOR_YELLOW, -1);
+    ui_ctrl_ritem (p->pfb, p->pui, m2_item [eITEM_MAC_ADDR].ui_id, COLOR_YELLOW, -1);
 
     if (efuse_control (p->efuse_data, EFUSE_READ)) {
         efuse_get_mac (p->efuse_data, p->mac);
@@ -821,42 +1107,62 @@ static int check_mac_addr (client_t *p)
             p->mac[6],  p->mac[7], p->mac[8],
             p->mac[9], p->mac[10], p->mac[11]);
 
-    ui_set_sitem (p->pfb, p->pui, m2_item [eITEM_MAC_ADDR].ui_id, -1, -1, str);
+    ui_ctrl_sitem (p->pfb, p->pui, m2_item [eITEM_MAC_ADDR].ui_id, -1, -1, str);
     m2_item[eITEM_MAC_ADDR].status = eSTATUS_STOP;
+    item_stream (p, eITEM_MAC_ADDR, str);
 
     if (m2_item [eITEM_MAC_ADDR].result) {
-        ui_set_ritem (p->pfb, p->pui, m2_item [eITEM_MAC_ADDR].ui_id, COLOR_GREEN, -1);
+        ui_ctrl_ritem (p->pfb, p->pui, m2_item [eITEM_MAC_ADDR].ui_id, COLOR_GREEN, -1);
         tolowerstr (p->mac);
 //        nlp_server_write (p->nlp_ip, NLP_SERVER_MSG_TYPE_MAC, p->mac, p->channel);
         return 1;
     }
-    ui_set_ritem (p->pfb, p->pui, m2_item [eITEM_MAC_ADDR].ui_id, COLOR_RED, -1);
+    ui_ctrl_ritem (p->pfb, p->pui, m2_item [eITEM_MAC_ADDR].ui_id, COLOR_RED, -1);
     return 0;
 }
 
 //------------------------------------------------------------------------------
 #define IPERF_SPEED_MIN 800
+#define IPERF_STREAMS   4
 
 static int check_iperf_speed (client_t *p)
 {
-    int value = 0, retry = 3;
+    int value = 0, retry = 3, cpu_usage = 0, cpu_per_mbit = 0;
     char str[32];
 
 retry_iperf:
     m2_item [eITEM_IPERF].status = eSTATUS_RUN;
-    ui_set_ritem (p->pfb, p->pui, m2_item [eITEM_IPERF].ui_id, COLOR_YELLOW, -1);
-    nlp_server_write (p->nlp_ip, NLP_SERVER_MSG_TYPE_UDP, "start", 0);  usleep (APP_LOOP_DELAY * 1000);
-    value = iperf3_speed_check(p->nlp_ip, NLP_SERVER_MSG_TYPE_UDP);
-    nlp_server_write (p->nlp_ip, NLP_SERVER_MSG_TYPE_UDP, "stop", 0);   usleep (APP_LOOP_DELAY * 1000);
+    ui_ctrl_ritem (p->pfb, p->pui, m2_item [eITEM_IPERF].ui_id, COLOR_YELLOW, -1);
+    // iperf3 server must be ready before the client runs.
+    server_send (NLP_SERVER_MSG_TYPE_UDP, "start", 0);
+    server_sync (SERVER_SYNC_TIMEOUT);  usleep (APP_LOOP_DELAY * 1000);
+
+    // eth0 irq/rps and iperf3 streams run on the big cores (RK3588 A76)
+    ethernet_affinity_set ();
+    value = ethernet_iperf_check (p->nlp_ip, IPERF_STREAMS, &cpu_usage);
+    ethernet_affinity_restore ();
+
+    server_send (NLP_SERVER_MSG_TYPE_UDP, "stop", 0);    usleep (APP_LOOP_DELAY * 1000);
+
+    // effective cpu usage per Mbit (x 0.0001 %)
+    cpu_per_mbit = value ? (cpu_usage * 100) / value : 0;
+    printf ("%s : %d Mbits/sec, cpu %d.%02d%%, %d.%04d%%/Mbit\n", __func__,
+            value, cpu_usage / 100, cpu_usage % 100,
+            cpu_per_mbit / 10000, cpu_per_mbit % 10000);
 
     memset  (str, 0, sizeof(str));
     sprintf (str, "%d Mbits/sec", value);
 
-    ui_set_sitem (p->pfb, p->pui, m2_item [eITEM_IPERF].ui_id, -1, -1, str);
-    ui_set_ritem (p->pfb, p->pui, m2_item [eITEM_IPERF].ui_id, value > IPERF_SPEED_MIN ? COLOR_GREEN : COLOR_RED, -1);
+    ui_ctrl_sitem (p->pfb, p->pui, m2_item [eITEM_IPERF].ui_id, -1, -1, str);
+    ui_ctrl_ritem (p->pfb, p->pui, m2_item [eITEM_IPERF].ui_id, value > IPERF_SPEED_MIN ? COLOR_GREEN : COLOR_RED, -1);
     m2_item [eITEM_IPERF].result = value > IPERF_SPEED_MIN ? eRESULT_PASS : eRESULT_FAIL;
     m2_item [eITEM_IPERF].status = eSTATUS_STOP;
 
+    // "<Mbits>,<cpu %/Mbit x 10000>"
+    memset  (str, 0, sizeof(str));
+    sprintf (str, "%d,%d", value, cpu_per_mbit);
+    item_stream (p, eITEM_IPERF, str);
+
     if (!m2_item [eITEM_IPERF].result) {
         usleep (APP_LOOP_DELAY * 1000);
         if (retry) {    retry--;    goto retry_iperf;   }
@@ -866,29 +1172,124 @@ retry_iperf:
 
 //------------------------------------------------------------------------------
 #define I2C_ADC_DEV "gpio,sda,116,scl,117"
+#define I2C_ADC_SDA 116
+#define I2C_ADC_SCL 117
+
+// kernel i2c-gpio adapter on the same pins (dt overlay), used through i2c-dev.
+#define I2C_ADC_DRIVER  "i2c-gpio"
+#define I2C_SYSFS_PATH  "/sys/bus/i2c/devices"
+
+// adc board snapshot freshness (ms), shared by the model detect readers.
+#define ADC_SVC_FRESH_MS    50
+
+//------------------------------------------------------------------------------
+// big endian u32 cells of a device tree property. return : cell count
+//------------------------------------------------------------------------------
+static int dt_cells (const char *path, unsigned int *cells, int max)
+{
+    unsigned char buf[64];
+    int fd, len, i;
+
+    if ((fd = open (path, O_RDONLY)) < 0)
+        return 0;
+    len = read (fd, buf, sizeof(buf));
+    close (fd);
+
+    for (i = 0; (i < max) && ((i + 1) * 4 <= len); i++)
+        cells[i] = (buf[i*4] << 24) | (buf[i*4+1] << 16) | (buf[i*4+2] << 8) | buf[i*4+3];
+    return i;
+}
+
+//------------------------------------------------------------------------------
+// dt gpio property (<&gpioN pin flags>) of the adapter == gpio number.
+// gpio number / 32 = gpiochip (bank), gpio number % 32 = pin.
+//------------------------------------------------------------------------------
+static int i2cadc_pin_match (const char *adapter, const char *prop, int gpio)
+{
+    char path[PATH_MAX];
+    unsigned int spec[3], phandle;
+
+    snprintf (path, sizeof(path), "%s/%s/device/of_node/%s", I2C_SYSFS_PATH, adapter, prop);
+    if (dt_cells (path, spec, 3) < 2)
+        return 0;
+
+    snprintf (path, sizeof(path), "/sys/bus/gpio/devices/gpiochip%d/of_node/phandle", gpio / 32);
+    if (dt_cells (path, &phandle, 1) != 1)
+        return 0;
+
+    return (spec[0] == phandle) && ((int)spec[1] == (gpio % 32));
+}
+
+//------------------------------------------------------------------------------
+// /dev/i2c-N of the i2c-gpio adapter on the adc board pins (sda/scl-gpios of
+// the dt node) if loaded, else the bit-bang gpio string.
+//------------------------------------------------------------------------------
+static const char *i2cadc_dev (void)
+{
+    static char dev[32];
+    char path[PATH_MAX], link[PATH_MAX], *ptr;
+    struct dirent *d;
+    DIR *dir;
+    int len;
+
+    if (dev[0])
+        return dev;
+
+    strcpy (dev, I2C_ADC_DEV);
+    if ((dir = opendir (I2C_SYSFS_PATH)) == NULL)
+        return dev;
+
+    while ((d = readdir (dir)) != NULL) {
+        if (strncmp (d->d_name, "i2c-", 4))
+            continue;
+        // adapter parent : /sys/bus/platform/drivers/i2c-gpio
+        snprintf (path, sizeof(path), "%s/%s/device/driver", I2C_SYSFS_PATH, d->d_name);
+        if ((len = readlink (path, link, sizeof(link) -1)) <= 0)
+            continue;
+        link[len] = 0;
+        ptr = strrchr (link, '/');
+        if (strcmp (ptr ? ptr + 1 : link, I2C_ADC_DRIVER))
+            continue;
+        // other i2c-gpio buses (overlays) are not the adc board.
+        if (!i2cadc_pin_match (d->d_name, "sda-gpios", I2C_ADC_SDA) ||
+            !i2cadc_pin_match (d->d_name, "scl-gpios", I2C_ADC_SCL))
+            continue;
+        snprintf (path, sizeof(path), "/dev/%s", d->d_name);
+        if (access (path, R_OK | W_OK) == 0) {
+            snprintf (dev, sizeof(dev), "%s", path);
+            break;
+        }
+    }
+    closedir (dir);
+    printf ("%s : adc board i2c = %s\n", __func__, dev);
+    return dev;
+}
 
 static int check_i2cadc (client_t *p)
 {
     // ADC Board Check
     int value = 0, cnt = 1;
 
-    if (p->adc_fd == 0 )    p->adc_fd = adc_board_init (I2C_ADC_DEV);
+    if (p->adc_fd == 0 ) {
+        p->adc_fd = adc_board_init (i2cadc_dev ());
+        adc_svc_init (p->adc_fd, ADC_SVC_FRESH_MS);
+    }
 
     if (p->adc_fd != 0 ) {
         // DC Jack 12V ~ 19V Check (2.4V ~ 3.8V)
-        adc_board_read (p->adc_fd, "P13.2", &value, &cnt);
+        adc_svc_read ("P13.2", ADC_SVC_FRESH, &value, &cnt);
         if (value > 2000) {
-            adc_board_read (p->adc_fd, "P3.2", &value, &cnt);
+            adc_svc_read ("P3.2", ADC_SVC_FRESH, &value, &cnt);
             p->channel = (value > 4000) ? NLP_SERVER_CHANNEL_RIGHT : NLP_SERVER_CHANNEL_LEFT;
 
             p->test_model = TEST_MODEL_NONE;
             // Test Model 8GB
-            adc_board_read (p->adc_fd, "P3.8", &value, &cnt);
+            adc_svc_read ("P3.8", ADC_SVC_FRESH, &value, &cnt);
             if (value > 4000)
                 p->test_model = TEST_MODEL_8GB;
 
             // Test Model 16GB
-            adc_board_read (p->adc_fd, "P3.9", &value, &cnt);
+            adc_svc_read ("P3.9", ADC_SVC_FRESH, &value, &cnt);
             if (value > 4000)
                 p->test_model = TEST_MODEL_16GB;
 
@@ -906,39 +1307,54 @@ static int check_server (client_t *p)
     memset (ip_addr, 0, sizeof(ip_addr));
 
     m2_item [eITEM_BOARD_IP].status = m2_item [eITEM_SERVER_IP].status = eSTATUS_RUN;
-    ui_set_ritem (p->pfb, p->pui, m2_item [eITEM_BOARD_IP].ui_id, COLOR_YELLOW, -1);
-    if (get_my_ip (ip_addr)) {
-        ui_set_sitem (p->pfb, p->pui, m2_item [eITEM_BOARD_IP].ui_id, -1, -1, ip_addr);
-        ui_set_ritem (p->pfb, p->pui, m2_item [eITEM_BOARD_IP].ui_id, p->pui->bc.uint, -1);
+    ui_ctrl_ritem (p->pfb, p->pui, m2_item [eITEM_BOARD_IP].ui_id, COLOR_YELLOW, -1);
+    if (ethernet_ip_wait (ip_addr, IP_WAIT_TIMEOUT)) {
+        memcpy (p->board_ip, ip_addr, IP_ADDR_SIZE);
+        ui_ctrl_sitem (p->pfb, p->pui, m2_item [eITEM_BOARD_IP].ui_id, -1, -1, ip_addr);
+        ui_ctrl_ritem (p->pfb, p->pui, m2_item [eITEM_BOARD_IP].ui_id, p->pui->bc.uint, -1);
         m2_item [eITEM_BOARD_IP].result = eRESULT_PASS;
         m2_item [eITEM_BOARD_IP].status = eSTATUS_STOP;
 
         memset (ip_addr, 0, sizeof(ip_addr));
 
-        ui_set_ritem (p->pfb, p->pui, m2_item [eITEM_SERVER_IP].ui_id, COLOR_YELLOW, -1);
-        if (nlp_server_find(ip_addr)) {
+        ui_ctrl_ritem (p->pfb, p->pui, m2_item [eITEM_SERVER_IP].ui_id, COLOR_YELLOW, -1);
+        if (server_find (p->board_ip, ip_addr)) {
             memcpy (p->nlp_ip, ip_addr, IP_ADDR_SIZE);
-            ui_set_sitem (p->pfb, p->pui, m2_item [eITEM_SERVER_IP].ui_id, -1, -1, ip_addr);
-            ui_set_ritem (p->pfb, p->pui, m2_item [eITEM_SERVER_IP].ui_id, p->pui->bc.uint, -1);
+            server_sender_init (p->nlp_ip);
+            item_value (eITEM_BOARD_IP, p->board_ip);
+            ui_ctrl_sitem (p->pfb, p->pui, m2_item [eITEM_SERVER_IP].ui_id, -1, -1, ip_addr);
+            ui_ctrl_ritem (p->pfb, p->pui, m2_item [eITEM_SERVER_IP].ui_id, p->pui->bc.uint, -1);
             m2_item [eITEM_SERVER_IP].result = eRESULT_PASS;
             m2_item [eITEM_SERVER_IP].status = eSTATUS_STOP;
+            item_value (eITEM_SERVER_IP, p->nlp_ip);
+            item_stream_flush (p);
+
+            // dhcp latency metric (ms)
+            memset  (ip_addr, 0, sizeof(ip_addr));
+            sprintf (ip_addr, "%d", ethernet_ip_latency ());
+            server_result (p->channel, "dhcp", 1, ip_addr);
             return 1;
         } else {
-            ui_set_ritem (p->pfb, p->pui, m2_item [eITEM_SERVER_IP].ui_id, COLOR_RED, -1);
+            ui_ctrl_ritem (p->pfb, p->pui, m2_item [eITEM_SERVER_IP].ui_id, COLOR_RED, -1);
         }
     } else {
-        ui_set_ritem (p->pfb, p->pui, m2_item [eITEM_BOARD_IP].ui_id, COLOR_RED, -1);
+        ui_ctrl_ritem (p->pfb, p->pui, m2_item [eITEM_BOARD_IP].ui_id, COLOR_RED, -1);
     }
 
     return 0;
 }
 
 //------------------------------------------------------------------------------
-static int audio_sine_wave (client_t *p, int ch)
+// mv : last adc value (mV) of the audio detect pin
+static int audio_sine_wave (client_t *p, int ch, int *mv)
 {
     int value = 0, cnt = 0, loop, retry = 3;
 
-    adc_board_read (p->adc_fd, ch ? "P13.3" : "P13.4", &value, &cnt);
+    *mv = 0;
+    if (p->adc_fd <= 0)     return 0;
+
+    adc_svc_read (ch ? "P13.3" : "P13.4", 0, &value, &cnt);
+    *mv = value;
 
     // default high
     if (value < 3000)   return 0;
@@ -947,7 +1363,8 @@ static int audio_sine_wave (client_t *p, int ch)
     while (audio_check (ch) == 2)   usleep (100 * 1000);
 
     for (loop = 0; loop < retry; loop++) {
-        adc_board_read (p->adc_fd, ch ? "P13.3" : "P13.4", &value, &cnt);
+        adc_svc_read (ch ? "P13.3" : "P13.4", 0, &value, &cnt);
+        *mv = value;
         if (value < 100)    return 1;
         usleep (100 * 1000);
     }
@@ -956,34 +1373,41 @@ static int audio_sine_wave (client_t *p, int ch)
 
 static int check_device_audio (client_t *p)
 {
+    char str[16];
+    int mv;
+
     if (!m2_item [eITEM_AUDIO_LEFT].result) {
         m2_item [eITEM_AUDIO_LEFT].status = eSTATUS_RUN;
-        ui_set_ritem (p->pfb, p->pui, m2_item [eITEM_AUDIO_LEFT].ui_id, COLOR_YELLOW, -1);
+        ui_ctrl_ritem (p->pfb, p->pui, m2_item [eITEM_AUDIO_LEFT].ui_id, COLOR_YELLOW, -1);
 
-        if (audio_sine_wave (p, 0)) {
+        if (audio_sine_wave (p, 0, &mv)) {
             m2_item [eITEM_AUDIO_LEFT].result = eRESULT_PASS;
-            ui_set_sitem (p->pfb, p->pui, m2_item [eITEM_AUDIO_LEFT].ui_id, -1, -1, "PASS");
-            ui_set_ritem (p->pfb, p->pui, m2_item [eITEM_AUDIO_LEFT].ui_id, COLOR_GREEN, -1);
+            ui_ctrl_sitem (p->pfb, p->pui, m2_item [eITEM_AUDIO_LEFT].ui_id, -1, -1, "PASS");
+            ui_ctrl_ritem (p->pfb, p->pui, m2_item [eITEM_AUDIO_LEFT].ui_id, COLOR_GREEN, -1);
         } else {
-            ui_set_sitem (p->pfb, p->pui, m2_item [eITEM_AUDIO_LEFT].ui_id, -1, -1, "FAIL");
-            ui_set_ritem (p->pfb, p->pui, m2_item [eITEM_AUDIO_LEFT].ui_id, COLOR_RED, -1);
+            ui_ctrl_sitem (p->pfb, p->pui, m2_item [eITEM_AUDIO_LEFT].ui_id, -1, -1, "FAIL");
+            ui_ctrl_ritem (p->pfb, p->pui, m2_item [eITEM_AUDIO_LEFT].ui_id, COLOR_RED, -1);
         }
         m2_item [eITEM_AUDIO_LEFT].status = eSTATUS_STOP;
+        memset (str, 0, sizeof(str));   sprintf (str, "%d", mv);
+        item_stream (p, eITEM_AUDIO_LEFT, str);
     }
 
     if (!m2_item [eITEM_AUDIO_RIGHT].result) {
         m2_item [eITEM_AUDIO_RIGHT].status = eSTATUS_RUN;
-        ui_set_ritem (p->pfb, p->pui, m2_item [eITEM_AUDIO_RIGHT].ui_id, COLOR_YELLOW, -1);
+        ui_ctrl_ritem (p->pfb, p->pui, m2_item [eITEM_AUDIO_RIGHT].ui_id, COLOR_YELLOW, -1);
 
-        if (audio_sine_wave (p, 1)) {
+        if (audio_sine_wave (p, 1, &mv)) {
             m2_item [eITEM_AUDIO_RIGHT].result = eRESULT_PASS;
-            ui_set_sitem (p->pfb, p->pui, m2_item [eITEM_AUDIO_RIGHT].ui_id, -1, -1, "PASS");
-            ui_set_ritem (p->pfb, p->pui, m2_item [eITEM_AUDIO_RIGHT].ui_id, COLOR_GREEN, -1);
+            ui_ctrl_sitem (p->pfb, p->pui, m2_item [eITEM_AUDIO_RIGHT].ui_id, -1, -1, "PASS");
+            ui_ctrl_ritem (p->pfb, p->pui, m2_item [eITEM_AUDIO_RIGHT].ui_id, COLOR_GREEN, -1);
         } else {
-            ui_set_sitem (p->pfb, p->pui, m2_item [eITEM_AUDIO_RIGHT].ui_id, -1, -1, "FAIL");
-            ui_set_ritem (p->pfb, p->pui, m2_item [eITEM_AUDIO_RIGHT].ui_id, COLOR_RED, -1);
+            ui_ctrl_sitem (p->pfb, p->pui, m2_item [eITEM_AUDIO_RIGHT].ui_id, -1, -1, "FAIL");
+            ui_ctrl_ritem (p->pfb, p->pui, m2_item [eITEM_AUDIO_RIGHT].ui_id, COLOR_RED, -1);
         }
         m2_item [eITEM_AUDIO_RIGHT].status = eSTATUS_STOP;
+        memset (str, 0, sizeof(str));   sprintf (str, "%d", mv);
+        item_stream (p, eITEM_AUDIO_RIGHT, str);
     }
     return 1;
 }
@@ -994,13 +1418,41 @@ static int client_setup (client_t *p)
     pthread_t thread_hp_detect, thread_check_status, thread_ethernet;
     pthread_t thread_usb, thread_storage;
 
-    if ((p->pfb = fb_init (DEVICE_FB)) == NULL)         exit(1);
-    if ((p->pui = ui_init (p->pfb, CONFIG_UI)) == NULL) exit(1);
+    if ((p->pfb = fb_init (p->fb_dev)) == NULL)         exit(1);
+    ui_ctrl_init (p->fb_dev, CONFIG_UI);
+
+    if (p->layout)
+        exit (ui_layout_build (p->pfb, CONFIG_UI, CONFIG_UI_BIN) ? 0 : 1);
+
+    if ((p->pui = ui_layout_load (p->pfb, CONFIG_UI, CONFIG_UI_BIN)) == NULL)
+        exit(1);
+
+    // headless rendering benchmark (vfb : modprobe vfb vfb_enable=1)
+    if (p->bench) {
+        ui_bench (p->pfb, p->pui, CONFIG_UI, p->bench);
+        fb_stream_bench (p->fb_dev, p->bench);
+        if (p->snapshot)
+            ui_ctrl_snapshot (p->snapshot);
+        exit(0);
+    }
+    // KMS output : lib_fbui draws to the fb_dev(vfb), atomic page flip.
+    if (p->kms && kms_present_init (p->kms, p->fb_dev))
+        ui_ctrl_present (kms_present);
+
+    // single lib_fbui caller (check threads queue the ui commands)
+    ui_ctrl_start (p->pfb, p->pui);
+
+    // remote screen (optional)
+    if (p->viewer)
+        fb_stream_start (p->fb_dev, p->viewer);
 
     pthread_create (&thread_check_status, NULL, check_status, p);
 
     check_device_hdmi(p);   check_device_system (p);
 
+    // ethernet loopback self-test (no peer needed, link down while running)
+    check_ethernet_loopback (p);
+
     while (!check_server (p))   usleep (APP_LOOP_DELAY * 1000);
 
     pthread_create (&thread_hp_detect,    NULL, check_hp_detect, p);
@@ -1018,12 +1470,45 @@ static int client_setup (client_t *p)
 }
 
 //------------------------------------------------------------------------------
-int main (void)
+static void print_usage (const char *prog)
+{
+    printf ("Usage: %s [-d fb_dev] [-b frames] [-s ppm_file] [-L] [-r ip[:port]] [-k drm_card]\n", prog);
+    puts ("  -d  framebuffer device (default " DEVICE_FB ", vfb : /dev/fb1)\n"
+          "  -b  run the ui rendering benchmark(frames) and exit\n"
+          "  -s  save the framebuffer to ppm file (bench end or FINISH)\n"
+          "  -L  build the binary ui layout (" CONFIG_UI " -> " CONFIG_UI_BIN ") and exit\n"
+          "  -r  stream the framebuffer(changed tiles) to the viewer pc\n"
+          "  -k  show fb_dev(vfb) on the drm card by atomic page flip (/dev/dri/card0)\n");
+    exit(1);
+}
+
+//------------------------------------------------------------------------------
+static void parse_opts (client_t *p, int argc, char **argv)
+{
+    int opt;
+
+    p->fb_dev = DEVICE_FB;
+    while ((opt = getopt (argc, argv, "d:b:s:Lr:k:h")) != -1) {
+        switch (opt) {
+            case 'd':   p->fb_dev   = optarg;           break;
+            case 'b':   p->bench    = atoi (optarg);    break;
+            case 's':   p->snapshot = optarg;           break;
+            case 'L':   p->layout   = 1;                break;
+            case 'r':   p->viewer   = optarg;           break;
+            case 'k':   p->kms      = optarg;           break;
+            default :   print_usage (argv[0]);          break;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+int main (int argc, char **argv)
 {
     client_t client;
     pthread_t thread_sw_adc;
 
     memset (&client, 0, sizeof(client));
+    parse_opts (&client, argc, argv);
 
     // UI
     client_setup (&client);